@@ -7,32 +7,32 @@ CONFIG += c++11
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(core.pri)
+
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    modelloader.h \
+    mosaicview.h \
+    overlaypainter.h \
+    previewscaler.h \
+    streamtablemodel.h \
+    videoview.h
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    modelloader.cpp \
+    mosaicview.cpp \
+    overlaypainter.cpp \
+    previewscaler.cpp \
+    streamtablemodel.cpp \
+    videoview.cpp
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
-# Include OpenCV
-INCLUDEPATH += /opt/homebrew/opt/opencv/include/opencv4
-LIBS += -L/opt/homebrew/opt/opencv/lib \
-        -lopencv_core \
-        -lopencv_highgui \
-        -lopencv_imgproc \
-        -lopencv_videoio \
-        -lopencv_imgcodecs \
-        -lopencv_video
-
-# Include InspireFace
-INCLUDEPATH += $$PWD/InspireFace/include
-LIBS += -L$$PWD/InspireFace/lib -lInspireFace
-
 # MacOS specific settings
 macx {
     QMAKE_CXXFLAGS += -std=c++11
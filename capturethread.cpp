@@ -0,0 +1,223 @@
+#include "capturethread.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+// First retry delay; doubles per failed attempt up to reconnectMaxDelayMs
+static const int kReconnectInitialDelayMs = 500;
+
+CaptureThread::CaptureThread(const CaptureSource &source, FrameQueue *queue, QObject *parent)
+    : QThread(parent)
+    , source(source)
+    , queue(queue)
+    , decodeHistogram(nullptr)
+    , pool(source.frameBuffers)
+{
+}
+
+CaptureThread::~CaptureThread()
+{
+    stop();
+}
+
+void CaptureThread::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+bool CaptureThread::openSource(cv::VideoCapture &capture)
+{
+    if (source.kind == CaptureSource::Webcam) {
+        if (!capture.open(source.deviceIndex)) {
+            return false;
+        }
+        capture.set(cv::CAP_PROP_FRAME_WIDTH, 1280);
+        capture.set(cv::CAP_PROP_FRAME_HEIGHT, 720);
+        capture.set(cv::CAP_PROP_FPS, 30);
+        return capture.isOpened();
+    }
+
+    if (source.kind == CaptureSource::File) {
+        qDebug() << "Membuka file video:" << source.url;
+        return capture.open(source.url.toStdString()) && capture.isOpened();
+    }
+
+    qDebug() << "Mencoba membuka RTSP stream:" << source.url;
+
+    // Method 1: Direct URL with TCP transport
+    QString tcpUrl = source.url;
+    if (!tcpUrl.contains("transport=")) {
+        tcpUrl += (tcpUrl.contains("?") ? "&" : "?") + QString("transport=tcp");
+    }
+    qDebug() << "Mencoba koneksi dengan URL TCP:" << tcpUrl;
+
+    // Bound how long FFmpeg may block on a dead camera, where OpenCV supports it
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    const std::vector<int> params = {
+        cv::CAP_PROP_OPEN_TIMEOUT_MSEC, source.connectTimeoutMs,
+        cv::CAP_PROP_READ_TIMEOUT_MSEC, source.connectTimeoutMs,
+    };
+    bool success = capture.open(tcpUrl.toStdString(), cv::CAP_FFMPEG, params);
+    if (!success && !isInterruptionRequested()) {
+        qDebug() << "Koneksi TCP gagal, mencoba URL langsung";
+        success = capture.open(source.url.toStdString(), cv::CAP_FFMPEG, params);
+    }
+#else
+    bool success = capture.open(tcpUrl.toStdString());
+    if (!success && !isInterruptionRequested()) {
+        qDebug() << "Koneksi TCP gagal, mencoba URL langsung";
+        success = capture.open(source.url.toStdString());
+    }
+#endif
+
+    if (!success) {
+        return false;
+    }
+
+    // Configure stream parameters after successful connection
+    capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    capture.set(cv::CAP_PROP_FPS, 30);
+    return capture.isOpened();
+}
+
+bool CaptureThread::sleepInterruptibly(int ms)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!isInterruptionRequested()) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return true;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            deadline - now, std::chrono::milliseconds(50)));
+    }
+    return false;
+}
+
+bool CaptureThread::connectSource(cv::VideoCapture &capture)
+{
+    // Only network streams are worth retrying; cameras and files fail for good
+    const bool retry = source.kind == CaptureSource::Rtsp;
+    std::mt19937 random(std::random_device{}());
+
+    for (int attempt = 0; !isInterruptionRequested(); ++attempt) {
+        if (attempt > 0) {
+            if (!retry || (source.reconnectAttempts > 0 && attempt >= source.reconnectAttempts)) break;
+
+            // Exponential backoff with jitter so cameras behind one switch do not reconnect in lockstep
+            const int ceiling = int(std::min<int64_t>(source.reconnectMaxDelayMs,
+                int64_t(kReconnectInitialDelayMs) << std::min(attempt - 1, 16)));
+            const int delayMs = std::uniform_int_distribution<int>(ceiling / 2, ceiling)(random);
+            emit stateChanged(BackingOff, attempt, delayMs);
+            if (!sleepInterruptibly(delayMs)) return false;
+        }
+
+        emit stateChanged(Connecting, attempt, 0);
+        capture.release();
+        if (openSource(capture)) {
+            emit stateChanged(Live, 0, 0);
+            return true;
+        }
+    }
+
+    if (!isInterruptionRequested()) emit stateChanged(Failed, 0, 0);
+    return false;
+}
+
+void CaptureThread::paceFile(double fps, std::chrono::steady_clock::time_point &next)
+{
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / fps));
+    const auto now = std::chrono::steady_clock::now();
+
+    // A reader that fell behind restarts the schedule instead of bursting to catch up
+    if (next < now - period) next = now;
+    std::this_thread::sleep_until(next);
+    next += period;
+}
+
+void CaptureThread::run()
+{
+    cv::VideoCapture capture;
+    if (!connectSource(capture)) {
+        if (!isInterruptionRequested()) {
+            qDebug() << "Semua metode koneksi gagal";
+            emit openFailed(source.kind == CaptureSource::Webcam ? QString() : source.url);
+        }
+        return;
+    }
+    emit opened();
+
+    double fileFps = source.replayFps;
+    if (source.kind == CaptureSource::File && fileFps == 0.0) {
+        fileFps = capture.get(cv::CAP_PROP_FPS);
+        if (fileFps <= 0.0) fileFps = 30.0;
+    }
+    auto nextFrame = std::chrono::steady_clock::now();
+    int loopsLeft = source.replayLoops;
+
+    uint64_t sequence = 0;
+    FramePtr frame;
+    while (!isInterruptionRequested()) {
+        // Kept across failed reads; published frames come back to the pool when their last owner is done
+        if (!frame) frame = pool.acquire();
+        const int64_t readStarted = LatencyHistogram::nowNs();
+        if (!pool.fill(frame->image, [&capture](cv::Mat &buffer) { return capture.read(buffer); })) {
+            if (source.kind == CaptureSource::Webcam) {
+                emit stateChanged(Failed, 0, 0);
+                emit connectionLost("Gagal membaca frame dari kamera");
+                break;
+            }
+
+            if (source.kind == CaptureSource::File) {
+                if (loopsLeft != 1 && capture.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                    if (loopsLeft > 1) --loopsLeft;
+                    continue;
+                }
+                emit stateChanged(Ended, 0, 0);
+                emit sourceEnded();
+                break;
+            }
+
+            // Reconnect with backoff; other streams keep running meanwhile
+            if (!connectSource(capture)) {
+                if (!isInterruptionRequested()) {
+                    emit connectionLost("Gagal membaca frame dan reconnect ke RTSP stream");
+                }
+                break;
+            }
+            continue;
+        }
+
+        const int64_t readFinished = LatencyHistogram::nowNs();
+        if (decodeHistogram) decodeHistogram->record(readFinished - readStarted);
+
+        const bool lossless = source.kind == CaptureSource::File && fileFps <= 0.0;
+        if (source.kind == CaptureSource::File && !lossless) {
+            paceFile(fileFps, nextFrame);
+        }
+
+        frame->sequence = ++sequence;
+        frame->keyFrame = source.keyFrameInterval <= 1 || frame->sequence % source.keyFrameInterval == 1;
+        if (lossless) {
+            // Lossless replay: wait for room instead of applying the drop policy,
+            // stamping each attempt so the wait does not count as frame age
+            for (;;) {
+                frame->captureTimeNs = LatencyHistogram::nowNs();
+                if (queue->tryPush(frame) || isInterruptionRequested()) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            if (frame) break;
+        } else {
+            frame->captureTimeNs = LatencyHistogram::nowNs();
+            queue->publish(std::move(frame));
+        }
+        if (frameCallback) {
+            frameCallback();
+        }
+    }
+
+    capture.release();
+}
@@ -0,0 +1,95 @@
+#ifndef CAPTURETHREAD_H
+#define CAPTURETHREAD_H
+
+#include <QThread>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "framepool.h"
+#include "framequeue.h"
+#include "latencyhistogram.h"
+
+namespace cv {
+    class VideoCapture;
+}
+
+struct CaptureSource
+{
+    enum Kind { Webcam, Rtsp, File };
+
+    Kind kind = Webcam;
+    int deviceIndex = 0;
+    QString url; // Stream URL, or the path of a recorded video for File
+
+    // File only. replayFps > 0 paces reads at that rate, 0 uses the rate stored
+    // in the file, < 0 replays losslessly as fast as frames are consumed
+    double replayFps = 0.0;
+    int replayLoops = 1; // 0 = loop forever
+
+    // Rtsp only. Failed connects are retried after an exponentially growing,
+    // jittered delay capped at reconnectMaxDelayMs; after reconnectAttempts
+    // consecutive failures (0 = never) the source gives up.
+    int reconnectAttempts = 0;
+    int reconnectMaxDelayMs = 30000;
+    int connectTimeoutMs = 5000; // FFmpeg open and read timeout
+
+    // Every n-th frame is marked as a key frame for FrameQueue's KeepKeyFrames
+    // policy; decoded cv::Mat frames carry no GOP information of their own
+    int keyFrameInterval = 1;
+
+    // Decode buffers recycled once every consumer has released them; frames
+    // beyond that get buffers of their own
+    int frameBuffers = 4;
+};
+
+// Owns a cv::VideoCapture and drains it continuously on its own thread,
+// publishing every decoded frame into a bounded FrameQueue. Network streams that
+// drop are reconnected here with backoff, so a dead camera only ever blocks
+// its own thread. Recorded files are paced or replayed losslessly (waiting
+// for room in the queue) and end with sourceEnded() instead.
+class CaptureThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum State { Connecting, Live, BackingOff, Failed, Ended };
+
+    CaptureThread(const CaptureSource &source, FrameQueue *queue, QObject *parent = nullptr);
+    ~CaptureThread();
+
+    void stop();
+
+    // Called on the capture thread after every published frame
+    void setFrameCallback(const std::function<void()> &callback) { frameCallback = callback; }
+
+    // Receives the duration of every successful read(); set before start()
+    void setDecodeHistogram(LatencyHistogram *histogram) { decodeHistogram = histogram; }
+
+    const FramePool &framePool() const { return pool; }
+
+signals:
+    void opened();
+    void openFailed(const QString &message);
+    void connectionLost(const QString &message);
+    void sourceEnded();
+    // attempt counts consecutive failed connects; delayMs is set while BackingOff
+    void stateChanged(int state, int attempt, int delayMs);
+
+protected:
+    void run() override;
+
+private:
+    bool openSource(cv::VideoCapture &capture);
+    bool connectSource(cv::VideoCapture &capture);
+    bool sleepInterruptibly(int ms);
+    void paceFile(double fps, std::chrono::steady_clock::time_point &next);
+
+    CaptureSource source;
+    FrameQueue *queue;
+    std::function<void()> frameCallback;
+    LatencyHistogram *decodeHistogram;
+    FramePool pool;
+};
+
+#endif // CAPTURETHREAD_H
@@ -0,0 +1,85 @@
+#include "configwriter.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+ConfigWriter::ConfigWriter(const QString &path, int debounceMs)
+    : path(path)
+    , debounce(debounceMs)
+    , hasPending(false)
+    , flushRequested(false)
+    , writing(false)
+    , stopping(false)
+{
+    writer = std::thread(&ConfigWriter::writerLoop, this);
+}
+
+ConfigWriter::~ConfigWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void ConfigWriter::save(const QJsonObject &config)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = config;
+        hasPending = true;
+        dueAt = std::chrono::steady_clock::now() + debounce;
+    }
+    wake.notify_one();
+}
+
+void ConfigWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!hasPending && !writing) return;
+    flushRequested = true;
+    wake.notify_one();
+    written.wait(lock, [this]() { return !hasPending && !writing; });
+}
+
+void ConfigWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (hasPending && (flushRequested || stopping || std::chrono::steady_clock::now() >= dueAt)) {
+            // Serialise outside the lock; a save() meanwhile just starts the next round
+            const QJsonObject config = pending;
+            pending = QJsonObject();
+            hasPending = false;
+            writing = true;
+            lock.unlock();
+            write(config);
+            lock.lock();
+            writing = false;
+            continue;
+        }
+        if (!hasPending) {
+            flushRequested = false;
+            written.notify_all();
+            if (stopping) return;
+            wake.wait(lock);
+        } else {
+            wake.wait_until(lock, dueAt);
+        }
+    }
+}
+
+void ConfigWriter::write(const QJsonObject &config)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Tidak dapat membuka file" << path << "untuk ditulis";
+        return;
+    }
+    file.write(QJsonDocument(config).toJson());
+    if (!file.commit()) {
+        qDebug() << "Gagal menyimpan" << path << ":" << file.errorString();
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CONFIGWRITER_H
+#define CONFIGWRITER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Writes a JSON config file on a background thread. save() only records the
+// latest document; the thread serialises it once saves have been quiet for
+// the debounce delay, so a burst of edits costs one write. Every write goes
+// through QSaveFile (temporary file, then rename), so a crash mid-write
+// leaves the previous file intact.
+class ConfigWriter
+{
+public:
+    explicit ConfigWriter(const QString &path, int debounceMs = 500);
+    ~ConfigWriter();
+
+    ConfigWriter(const ConfigWriter &) = delete;
+    ConfigWriter &operator=(const ConfigWriter &) = delete;
+
+    void save(const QJsonObject &config);
+    // Writes anything pending now and returns once it is on disk
+    void flush();
+
+private:
+    void writerLoop();
+    void write(const QJsonObject &config);
+
+    const QString path;
+    const std::chrono::milliseconds debounce;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    QJsonObject pending;
+    bool hasPending;
+    bool flushRequested;
+    bool writing;
+    bool stopping;
+    std::chrono::steady_clock::time_point dueAt;
+};
+
+#endif // CONFIGWRITER_H
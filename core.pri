@@ -0,0 +1,60 @@
+# Processing core shared by the GUI (FaceRec.pro) and the headless daemon
+# (headless/facerecd.pro). Needs QtCore only; nothing here may pull in widgets.
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    $$PWD/capturethread.h \
+    $$PWD/configwriter.h \
+    $$PWD/detectionscheduler.h \
+    $$PWD/engineconfig.h \
+    $$PWD/eventrecorder.h \
+    $$PWD/facedetection.h \
+    $$PWD/facegallery.h \
+    $$PWD/framemailbox.h \
+    $$PWD/framepool.h \
+    $$PWD/framequeue.h \
+    $$PWD/galleryenrollment.h \
+    $$PWD/galleryindex.h \
+    $$PWD/hnswindex.h \
+    $$PWD/latencyhistogram.h \
+    $$PWD/modelmanager.h \
+    $$PWD/modelset.h \
+    $$PWD/motiongate.h \
+    $$PWD/pipelinemetrics.h \
+    $$PWD/sessionpool.h \
+    $$PWD/sightingslog.h \
+    $$PWD/similaritykernels.h \
+    $$PWD/streamconfig.h \
+    $$PWD/streamengine.h \
+    $$PWD/streamregistry.h \
+    $$PWD/trackembeddingcache.h
+
+SOURCES += \
+    $$PWD/capturethread.cpp \
+    $$PWD/configwriter.cpp \
+    $$PWD/detectionscheduler.cpp \
+    $$PWD/engineconfig.cpp \
+    $$PWD/eventrecorder.cpp \
+    $$PWD/facegallery.cpp \
+    $$PWD/framepool.cpp \
+    $$PWD/galleryenrollment.cpp \
+    $$PWD/galleryindex.cpp \
+    $$PWD/hnswindex.cpp \
+    $$PWD/latencyhistogram.cpp \
+    $$PWD/modelmanager.cpp \
+    $$PWD/motiongate.cpp \
+    $$PWD/pipelinemetrics.cpp \
+    $$PWD/sessionpool.cpp \
+    $$PWD/sightingslog.cpp \
+    $$PWD/similaritykernels.cpp \
+    $$PWD/streamconfig.cpp \
+    $$PWD/streamengine.cpp \
+    $$PWD/streamregistry.cpp \
+    $$PWD/trackembeddingcache.cpp
+
+# Include OpenCV
+include($$PWD/opencv.pri)
+
+# Include InspireFace
+INCLUDEPATH += $$PWD/InspireFace/include
+LIBS += -L$$PWD/InspireFace/lib -lInspireFace
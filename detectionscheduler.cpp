@@ -0,0 +1,116 @@
+#include "detectionscheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kCostSmoothing = 0.2;
+// Detections this close to the session threshold are treated as unstable
+const float kLowConfidence = 0.8f;
+
+double smooth(double average, double sample)
+{
+    return average <= 0.0 ? sample : average + kCostSmoothing * (sample - average);
+}
+
+bool insideFrame(const cv::Rect &rect, const cv::Size &frameSize)
+{
+    return rect.x >= 0 && rect.y >= 0
+        && rect.x + rect.width <= frameSize.width
+        && rect.y + rect.height <= frameSize.height;
+}
+
+} // namespace
+
+DetectionScheduler::DetectionScheduler(double targetLatencyMs, int maxInterval)
+    : targetLatencyMs(targetLatencyMs)
+    , maxInterval(std::max(1, maxInterval))
+{
+    reset();
+}
+
+void DetectionScheduler::reset()
+{
+    detectInterval = 1;
+    framesSinceDetect = 0;
+    forceDetect = true;
+    detectCostMs = 0.0;
+    predictCostMs = 0.0;
+    lastFaceCount = 0;
+    motions.clear();
+}
+
+void DetectionScheduler::onDetected(std::vector<FaceDetection> &faces, const cv::Size &frameSize, double costMs)
+{
+    const int elapsedFrames = std::max(1, framesSinceDetect);
+    updated.clear();
+
+    bool unstable = int(faces.size()) != lastFaceCount;
+    for (const FaceDetection &face : faces) {
+        Motion motion;
+        motion.trackId = face.trackId;
+        motion.origin = face.rect;
+        motion.velocity = cv::Point2f(0.0f, 0.0f);
+        for (const Motion &previous : motions) {
+            if (previous.trackId == face.trackId) {
+                motion.velocity.x = float(face.rect.x - previous.origin.x) / elapsedFrames;
+                motion.velocity.y = float(face.rect.y - previous.origin.y) / elapsedFrames;
+                break;
+            }
+        }
+        updated.push_back(motion);
+
+        if (face.confidence < kLowConfidence || !insideFrame(face.rect, frameSize)) {
+            unstable = true;
+        }
+    }
+
+    motions.swap(updated);
+    lastFaceCount = int(faces.size());
+    framesSinceDetect = 1;
+    forceDetect = unstable;
+    detectCostMs = smooth(detectCostMs, costMs);
+    updateInterval();
+}
+
+void DetectionScheduler::predict(std::vector<FaceDetection> &faces, const cv::Size &frameSize)
+{
+    for (FaceDetection &face : faces) {
+        for (const Motion &motion : motions) {
+            if (motion.trackId != face.trackId) continue;
+
+            face.rect.x = motion.origin.x + int(std::lround(motion.velocity.x * framesSinceDetect));
+            face.rect.y = motion.origin.y + int(std::lround(motion.velocity.y * framesSinceDetect));
+            break;
+        }
+        face.predicted = true;
+
+        // A box drifting out of the frame means the extrapolation can no longer be trusted
+        if (!insideFrame(face.rect, frameSize)) {
+            forceDetect = true;
+        }
+    }
+    ++framesSinceDetect;
+}
+
+void DetectionScheduler::onPredicted(double costMs)
+{
+    predictCostMs = smooth(predictCostMs, costMs);
+    updateInterval();
+}
+
+void DetectionScheduler::updateInterval()
+{
+    // Average cost over one cycle is (detect + (N - 1) * predict) / N; pick the
+    // smallest N that keeps it within the target
+    if (detectCostMs <= targetLatencyMs) {
+        detectInterval = 1;
+        return;
+    }
+    if (predictCostMs >= targetLatencyMs) {
+        detectInterval = maxInterval;
+        return;
+    }
+    const double needed = (detectCostMs - predictCostMs) / (targetLatencyMs - predictCostMs);
+    detectInterval = std::min(maxInterval, std::max(1, int(std::ceil(needed))));
+}
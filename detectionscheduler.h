@@ -0,0 +1,50 @@
+#ifndef DETECTIONSCHEDULER_H
+#define DETECTIONSCHEDULER_H
+
+#include <vector>
+#include "facedetection.h"
+
+// Decides per frame whether a stream runs HFExecuteFaceTrack or only
+// extrapolates the last tracked boxes. The detection interval N is derived
+// from the measured cost of both kinds of frame so that the average cost per
+// frame stays within the target latency; detection is forced early whenever
+// the tracker looks unreliable.
+class DetectionScheduler
+{
+public:
+    DetectionScheduler(double targetLatencyMs = 33.0, int maxInterval = 5);
+
+    void reset();
+    bool detectDue() const { return forceDetect || framesSinceDetect >= detectInterval; }
+    int interval() const { return detectInterval; }
+
+    // Feed back a detection result; faces are updated with velocities in place
+    void onDetected(std::vector<FaceDetection> &faces, const cv::Size &frameSize, double costMs);
+
+    // Advances the last detections by one frame
+    void predict(std::vector<FaceDetection> &faces, const cv::Size &frameSize);
+    void onPredicted(double costMs);
+
+private:
+    struct Motion
+    {
+        int trackId;
+        cv::Rect origin;      // Box at the last detection
+        cv::Point2f velocity; // Pixels per frame
+    };
+
+    void updateInterval();
+
+    double targetLatencyMs;
+    int maxInterval;
+    int detectInterval;
+    int framesSinceDetect;
+    bool forceDetect;
+    double detectCostMs;  // EWMA
+    double predictCostMs; // EWMA
+    int lastFaceCount;
+    std::vector<Motion> motions;
+    std::vector<Motion> updated; // Scratch for onDetected(); swapped with motions, so neither reallocates
+};
+
+#endif // DETECTIONSCHEDULER_H
@@ -0,0 +1,69 @@
+#include "engineconfig.h"
+#include "facedetection.h"
+#include <algorithm>
+
+static void parseFaceStages(const QJsonObject &config, unsigned *forAll, unsigned *forMatched)
+{
+    struct Stage { const char *key; unsigned flag; };
+    const Stage stages[] = {
+        { "liveness", FaceStageLiveness },
+        { "mask", FaceStageMask },
+        { "attribute", FaceStageAttribute },
+    };
+
+    *forAll = 0;
+    *forMatched = 0;
+    for (const Stage &stage : stages) {
+        const QString when = config[stage.key].toString();
+        if (when == "all") {
+            *forAll |= stage.flag;
+        } else if (when == "matched") {
+            *forMatched |= stage.flag;
+        }
+    }
+}
+
+EngineConfig EngineConfig::fromJson(const QJsonObject &obj)
+{
+    EngineConfig config;
+    config.modelPath = obj["modelPath"].toString();
+    config.modelName = obj["modelName"].toString();
+    config.detectPixelLevel = obj["detectPixelLevel"].toInt(320);
+    config.maxDetectFaces = std::max(1, obj["maxDetectFaces"].toInt(20));
+    config.galleryPath = obj["galleryPath"].toString();
+    config.matchThreshold = obj["matchThreshold"].toDouble(0.48);
+    config.galleryIndex = obj["galleryIndex"].toObject();
+    config.embeddingRefreshMs = obj["embeddingRefreshMs"].toDouble(2000.0);
+    config.embeddingQualityGain = obj["embeddingQualityGain"].toDouble(0.1);
+    config.faceStages = obj["faceStages"].toObject();
+    parseFaceStages(config.faceStages, &config.stagesForAll, &config.stagesForMatched);
+    config.recording = obj["recording"].toObject();
+    config.sightingsPath = obj["sightingsPath"].toString();
+    return config;
+}
+
+void EngineConfig::writeJson(QJsonObject &obj) const
+{
+    obj["modelPath"] = modelPath;
+    if (!modelName.isEmpty()) {
+        obj["modelName"] = modelName;
+    }
+    obj["detectPixelLevel"] = detectPixelLevel;
+    obj["maxDetectFaces"] = maxDetectFaces;
+    obj["galleryPath"] = galleryPath;
+    obj["matchThreshold"] = matchThreshold;
+    obj["embeddingRefreshMs"] = embeddingRefreshMs;
+    obj["embeddingQualityGain"] = embeddingQualityGain;
+    if (!faceStages.isEmpty()) {
+        obj["faceStages"] = faceStages;
+    }
+    if (!galleryIndex.isEmpty()) {
+        obj["galleryIndex"] = galleryIndex;
+    }
+    if (!recording.isEmpty()) {
+        obj["recording"] = recording;
+    }
+    if (!sightingsPath.isEmpty()) {
+        obj["sightingsPath"] = sightingsPath;
+    }
+}
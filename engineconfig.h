@@ -0,0 +1,36 @@
+#ifndef ENGINECONFIG_H
+#define ENGINECONFIG_H
+
+#include <QString>
+#include <QJsonObject>
+
+// Top-level processing settings in streams.json, shared by the GUI and the
+// headless daemon
+struct EngineConfig
+{
+    QString modelPath;      // Directory holding the InspireFace model packs
+    QString modelName;      // Pack loaded last; the daemon loads it on start
+    int detectPixelLevel = 320;
+    int maxDetectFaces = 20; // Faces each session tracks at once
+    QString galleryPath;
+    double matchThreshold = 0.48;
+    QJsonObject galleryIndex; // See createGalleryIndex()
+    double embeddingRefreshMs = 2000.0;
+    double embeddingQualityGain = 0.1;
+
+    // "faceStages" maps each optional stage to "all" (every tracked face),
+    // "matched" (only faces recognised from the gallery) or "off"
+    QJsonObject faceStages;
+    unsigned stagesForAll = 0;     // FaceStage flags run on every tracked face
+    unsigned stagesForMatched = 0; // FaceStage flags run only on recognised faces
+
+    QJsonObject recording; // See RecorderSettings; no "path" means no recording
+    QString sightingsPath; // Directory of the sightings log, empty = off
+
+    QString modelFile() const { return modelPath + "/" + modelName; }
+
+    static EngineConfig fromJson(const QJsonObject &obj);
+    void writeJson(QJsonObject &obj) const;
+};
+
+#endif // ENGINECONFIG_H
@@ -0,0 +1,390 @@
+#include "eventrecorder.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <opencv2/imgcodecs.hpp>
+
+namespace {
+
+// Jobs an encoder may have waiting before new ones are shed
+const size_t kMaxQueuedJobs = 16;
+// Encoded event frames are handed to the writer in batches of about this size
+const size_t kWriteBatchBytes = 1 << 20;
+// A better crop of a track is only encoded when quality improved by this much
+const float kCropQualityStep = 0.05f;
+// Crops include some context around the detected box
+const double kCropMargin = 0.2;
+
+QString fileSafe(const QString &name)
+{
+    QString safe = name;
+    for (QChar &c : safe) {
+        if (!c.isLetterOrNumber() && c != '-' && c != '_') c = '_';
+    }
+    return safe.isEmpty() ? QString("stream") : safe;
+}
+
+} // namespace
+
+RecorderSettings RecorderSettings::fromJson(const QJsonObject &obj)
+{
+    RecorderSettings settings;
+    settings.path = obj["path"].toString();
+    settings.fps = std::max(0.1, obj["fps"].toDouble(10.0));
+    settings.preRollMs = std::max(0, obj["preRollMs"].toInt(3000));
+    settings.postRollMs = std::max(0, obj["postRollMs"].toInt(3000));
+    settings.quality = std::min(100, std::max(1, obj["quality"].toInt(80)));
+    settings.encoderThreads = std::max(1, obj["encoderThreads"].toInt(2));
+    settings.maxBacklogMb = std::max(1, obj["maxBacklogMb"].toInt(64));
+    return settings;
+}
+
+EventRecorder::EventRecorder()
+    : frameIntervalNs(0)
+    , writerStopping(false)
+    , backlogBytes(0)
+    , clips(0)
+    , shed(0)
+{
+}
+
+EventRecorder::~EventRecorder()
+{
+    stop();
+}
+
+void EventRecorder::setSettings(const RecorderSettings &recorderSettings)
+{
+    settings = recorderSettings;
+}
+
+void EventRecorder::start(const QStringList &streamNames)
+{
+    stop();
+    if (!enabled() || streamNames.isEmpty()) return;
+
+    frameIntervalNs = int64_t(1e9 / settings.fps);
+    clips.store(0, std::memory_order_relaxed);
+    shed.store(0, std::memory_order_relaxed);
+    backlogBytes.store(0, std::memory_order_relaxed);
+    for (const QString &name : streamNames) {
+        std::unique_ptr<StreamState> state(new StreamState);
+        state->name = name;
+        streams.push_back(std::move(state));
+    }
+
+    writerStopping = false;
+    writer = std::thread(&EventRecorder::writerLoop, this);
+    const int encoderCount = std::min(settings.encoderThreads, int(streams.size()));
+    for (int i = 0; i < encoderCount; ++i) {
+        std::unique_ptr<Encoder> encoder(new Encoder);
+        encoder->thread = std::thread(&EventRecorder::encoderLoop, this, encoder.get());
+        encoders.push_back(std::move(encoder));
+    }
+}
+
+void EventRecorder::stop()
+{
+    if (streams.empty()) return;
+
+    // Close open events; they are finished once the encoders drop their references
+    for (const std::unique_ptr<StreamState> &state : streams) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->event.reset();
+    }
+    for (const std::unique_ptr<Encoder> &encoder : encoders) {
+        {
+            std::lock_guard<std::mutex> lock(encoder->mutex);
+            encoder->stopping = true;
+        }
+        encoder->wake.notify_one();
+    }
+    for (const std::unique_ptr<Encoder> &encoder : encoders) {
+        encoder->thread.join();
+    }
+    encoders.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerStopping = true;
+    }
+    writerWake.notify_one();
+    writer.join();
+    streams.clear();
+}
+
+void EventRecorder::onFrame(int stream, const CapturedFrame &frame, const std::vector<FaceDetection> &faces)
+{
+    if (stream < 0 || stream >= int(streams.size())) return;
+
+    StreamState &state = *streams[stream];
+    const int64_t timeNs = frame.captureTimeNs;
+    std::shared_ptr<Event> event;
+    std::vector<Job> &crops = state.crops;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!faces.empty()) {
+            state.lastFaceNs = timeNs;
+            if (!state.event) state.event = openEvent(state, timeNs);
+        } else if (state.event && timeNs - state.lastFaceNs > int64_t(settings.postRollMs) * 1000000) {
+            state.event.reset();
+        }
+        event = state.event;
+
+        // Remember every track and ask for a crop whenever a sharper view turns up
+        if (event) {
+            for (const FaceDetection &face : faces) {
+                auto track = std::find_if(event->tracks.begin(), event->tracks.end(),
+                                          [&face](const TrackInfo &info) { return info.trackId == face.trackId; });
+                if (track == event->tracks.end()) {
+                    event->tracks.push_back(TrackInfo{face.trackId, QString(), -1.0f, std::vector<uchar>()});
+                    track = event->tracks.end() - 1;
+                }
+                if (face.identity >= 0) track->name = face.name;
+                if (face.predicted || face.quality < 0.0f || face.quality < track->quality + kCropQualityStep) continue;
+
+                track->quality = face.quality;
+                const int marginX = int(face.rect.width * kCropMargin);
+                const int marginY = int(face.rect.height * kCropMargin);
+                const cv::Rect crop = cv::Rect(face.rect.x - marginX, face.rect.y - marginY,
+                                               face.rect.width + 2 * marginX, face.rect.height + 2 * marginY)
+                                      & cv::Rect(0, 0, frame.image.cols, frame.image.rows);
+                if (crop.area() > 0) {
+                    crops.push_back(Job{stream, timeNs, frame.image, crop, face.trackId, event});
+                }
+            }
+        }
+    }
+
+    // Disk falling behind: keep detection and the pre-roll ring going, shed event work
+    const bool backlogged = backlogBytes.load(std::memory_order_relaxed)
+                            > size_t(settings.maxBacklogMb) << 20;
+    if (backlogged && event) {
+        shed.fetch_add(crops.size(), std::memory_order_relaxed);
+        crops.clear();
+    }
+    for (Job &crop : crops) {
+        submit(std::move(crop));
+    }
+    crops.clear();
+
+    // Clip frames are sampled at the recording rate, independent of the camera's
+    if (timeNs < state.nextSampleNs) return;
+    state.nextSampleNs = timeNs - state.nextSampleNs > frameIntervalNs ? timeNs + frameIntervalNs
+                                                                       : state.nextSampleNs + frameIntervalNs;
+    if (backlogged && event) {
+        shed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    submit(Job{stream, timeNs, frame.image, cv::Rect(), -1, event});
+}
+
+int64_t EventRecorder::openEventMs(int stream)
+{
+    if (stream < 0 || stream >= int(streams.size())) return 0;
+
+    StreamState &state = *streams[stream];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.event ? state.event->startMs : 0;
+}
+
+std::shared_ptr<EventRecorder::Event> EventRecorder::openEvent(StreamState &state, int64_t timeNs)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    Event *event = new Event;
+    event->streamName = state.name;
+    event->startMs = now.toMSecsSinceEpoch();
+    event->basePath = QDir(settings.path).filePath(fileSafe(state.name) + "/"
+                                                   + now.toString("yyyyMMdd-HHmmss-zzz"));
+
+    // Pre-roll: whatever the ring holds from the last preRollMs
+    const int64_t since = timeNs - int64_t(settings.preRollMs) * 1000000;
+    for (const EncodedFramePtr &frame : state.ring) {
+        if (frame->timeNs < since) continue;
+        event->pending.push_back(frame);
+        event->frameTimes.push_back(frame->timeNs);
+        event->pendingBytes += frame->jpeg.size();
+    }
+    return std::shared_ptr<Event>(event, [this](Event *finished) { finishEvent(finished); });
+}
+
+void EventRecorder::submit(Job job)
+{
+    Encoder &encoder = *encoders[job.stream % encoders.size()];
+    {
+        std::lock_guard<std::mutex> lock(encoder.mutex);
+        if (encoder.jobs.size() >= kMaxQueuedJobs) {
+            shed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        encoder.jobs.push_back(std::move(job));
+    }
+    encoder.wake.notify_one();
+}
+
+void EventRecorder::encoderLoop(Encoder *encoder)
+{
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(encoder->mutex);
+            encoder->wake.wait(lock, [encoder]() { return !encoder->jobs.empty() || encoder->stopping; });
+            if (encoder->jobs.empty()) return;
+            job = std::move(encoder->jobs.front());
+            encoder->jobs.pop_front();
+        }
+        encode(job);
+    }
+}
+
+void EventRecorder::encode(Job &job)
+{
+    StreamState &state = *streams[job.stream];
+    const std::vector<int> params = { cv::IMWRITE_JPEG_QUALITY, settings.quality };
+
+    if (!job.crop.empty()) {
+        std::vector<uchar> jpeg;
+        if (!cv::imencode(".jpg", job.image(job.crop), jpeg, params)) return;
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (TrackInfo &track : job.event->tracks) {
+            if (track.trackId == job.trackId) track.crop.swap(jpeg);
+        }
+        return;
+    }
+
+    std::shared_ptr<EncodedFrame> frame(new EncodedFrame);
+    frame->timeNs = job.timeNs;
+    if (!cv::imencode(".jpg", job.image, frame->jpeg, params)) return;
+    job.image.release();
+
+    WriteTask batch = { nullptr, nullptr, std::vector<EncodedFramePtr>(), 0 };
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.ring.push_back(frame);
+        const int64_t since = job.timeNs - int64_t(settings.preRollMs) * 1000000;
+        while (state.ring.front()->timeNs < since) state.ring.pop_front();
+
+        // A frame sampled just before the event opened still belongs to its pre-roll
+        Event *event = job.event ? job.event.get() : state.event.get();
+        if (event) {
+            event->pending.push_back(frame);
+            event->frameTimes.push_back(frame->timeNs);
+            event->pendingBytes += frame->jpeg.size();
+            if (event->pendingBytes >= kWriteBatchBytes) {
+                batch.event = job.event ? job.event : state.event;
+                batch.frames.swap(event->pending);
+                batch.bytes = event->pendingBytes;
+                event->pendingBytes = 0;
+            }
+        }
+    }
+    if (batch.event) queueWrite(std::move(batch));
+}
+
+void EventRecorder::finishEvent(Event *event)
+{
+    // Runs wherever the last reference was dropped; the writer does the rest
+    queueWrite(WriteTask{ event, nullptr, std::vector<EncodedFramePtr>(), event->pendingBytes });
+}
+
+void EventRecorder::queueWrite(WriteTask task)
+{
+    backlogBytes.fetch_add(task.bytes, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writes.push_back(std::move(task));
+    }
+    writerWake.notify_one();
+}
+
+void EventRecorder::writerLoop()
+{
+    for (;;) {
+        WriteTask task;
+        {
+            std::unique_lock<std::mutex> lock(writerMutex);
+            writerWake.wait(lock, [this]() { return !writes.empty() || writerStopping; });
+            if (writes.empty()) return;
+            task = std::move(writes.front());
+            writes.pop_front();
+        }
+
+        if (task.finished) {
+            std::unique_ptr<Event> event(task.finished);
+            writeFrames(*event, event->pending);
+            for (const TrackInfo &track : event->tracks) {
+                if (track.crop.empty()) continue;
+                QFile file(QString("%1-track%2.jpg").arg(event->basePath).arg(track.trackId));
+                if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    file.write(reinterpret_cast<const char *>(track.crop.data()), qint64(track.crop.size()));
+                }
+            }
+            writeMetadata(*event);
+            clips.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            writeFrames(*task.event, task.frames);
+        }
+        backlogBytes.fetch_sub(task.bytes, std::memory_order_relaxed);
+    }
+}
+
+void EventRecorder::writeFrames(Event &event, const std::vector<EncodedFramePtr> &frames)
+{
+    if (frames.empty()) return;
+
+    const QString path = event.basePath + ".mjpeg";
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Gagal menulis rekaman:" << path;
+        return;
+    }
+    for (const EncodedFramePtr &frame : frames) {
+        file.write(reinterpret_cast<const char *>(frame->jpeg.data()), qint64(frame->jpeg.size()));
+    }
+}
+
+void EventRecorder::writeMetadata(const Event &event)
+{
+    QJsonArray frameTimes;
+    const int64_t first = event.frameTimes.empty() ? 0 : event.frameTimes.front();
+    for (int64_t timeNs : event.frameTimes) {
+        frameTimes.append(double(timeNs - first) / 1e6);
+    }
+
+    QJsonArray tracks;
+    for (const TrackInfo &track : event.tracks) {
+        QJsonObject item;
+        item["trackId"] = track.trackId;
+        if (!track.name.isEmpty()) {
+            item["identity"] = track.name;
+        }
+        if (!track.crop.empty()) {
+            item["crop"] = QFileInfo(QString("%1-track%2.jpg").arg(event.basePath).arg(track.trackId)).fileName();
+            item["quality"] = track.quality;
+        }
+        tracks.append(item);
+    }
+
+    QJsonObject root;
+    root["stream"] = event.streamName;
+    root["start"] = QDateTime::fromMSecsSinceEpoch(event.startMs).toString(Qt::ISODateWithMs);
+    root["video"] = QFileInfo(event.basePath + ".mjpeg").fileName();
+    root["frames"] = int(event.frameTimes.size());
+    root["frameTimesMs"] = frameTimes;
+    root["tracks"] = tracks;
+
+    QDir().mkpath(QFileInfo(event.basePath).absolutePath());
+    QFile file(event.basePath + ".json");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Gagal menulis metadata rekaman:" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson());
+}
@@ -0,0 +1,164 @@
+#ifndef EVENTRECORDER_H
+#define EVENTRECORDER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "facedetection.h"
+#include "framemailbox.h"
+
+// "recording" in streams.json
+struct RecorderSettings
+{
+    QString path;            // Clip directory; empty disables recording
+    double fps = 10.0;       // Frames per second kept for pre-roll and clips
+    int preRollMs = 3000;    // Video kept from before the first face
+    int postRollMs = 3000;   // Video kept after the last face; also ends the event
+    int quality = 80;        // JPEG quality of clip frames and face crops
+    int encoderThreads = 2;
+    int maxBacklogMb = 64;   // Encoded data waiting for the disk before event frames are shed
+
+    static RecorderSettings fromJson(const QJsonObject &obj);
+};
+
+// Writes a clip and the best crop of every track whenever faces appear on a
+// stream. Each stream keeps a ring of recent JPEG frames for the pre-roll;
+// an event runs from the first face until postRollMs after the last one and
+// is written as <stream>/<time>.mjpeg (concatenated JPEGs), a .json with
+// frame times and tracks, and one -track<id>.jpg per track.
+//
+// onFrame() only samples, shares the frame's cv::Mat and queues work, so the
+// engine workers never wait on encoding or the disk. JPEG encoding runs on a
+// small pool where each stream always lands on the same thread (keeping its
+// frames in order), and a single writer thread appends batches to disk.
+// When an encoder queue is full or the writer falls behind, recording sheds
+// frames rather than slowing detection down.
+class EventRecorder
+{
+public:
+    EventRecorder();
+    ~EventRecorder();
+
+    EventRecorder(const EventRecorder &) = delete;
+    EventRecorder &operator=(const EventRecorder &) = delete;
+
+    // Takes effect on the next start()
+    void setSettings(const RecorderSettings &settings);
+    bool enabled() const { return !settings.path.isEmpty(); }
+
+    void start(const QStringList &streamNames);
+    // Ends open events and returns once everything queued is on disk
+    void stop();
+
+    // Called by the worker that holds stream; frames must not be modified afterwards
+    void onFrame(int stream, const CapturedFrame &frame, const std::vector<FaceDetection> &faces);
+
+    // Wall-clock start of the event open on stream, 0 when none; names its files
+    int64_t openEventMs(int stream);
+
+    uint64_t clipsWritten() const { return clips.load(std::memory_order_relaxed); }
+    uint64_t shedFrames() const { return shed.load(std::memory_order_relaxed); }
+
+private:
+    struct EncodedFrame
+    {
+        int64_t timeNs;
+        std::vector<uchar> jpeg;
+    };
+    typedef std::shared_ptr<const EncodedFrame> EncodedFramePtr;
+
+    struct TrackInfo
+    {
+        int trackId;
+        QString name; // Gallery name once recognised
+        float quality; // Of the best crop requested so far
+        std::vector<uchar> crop; // JPEG
+    };
+
+    // One clip. Shared by the stream while open and by every queued job for
+    // it; dropping the last reference hands it to the writer to finish.
+    struct Event
+    {
+        QString streamName;
+        QString basePath;    // Without extension
+        qint64 startMs;      // Wall clock, for the metadata
+        std::vector<EncodedFramePtr> pending; // Not yet handed to the writer
+        std::vector<int64_t> frameTimes;      // Everything written or pending
+        std::vector<TrackInfo> tracks;
+        size_t pendingBytes = 0;
+    };
+
+    struct Job
+    {
+        int stream;
+        int64_t timeNs;
+        cv::Mat image;                // Shares the captured frame
+        cv::Rect crop;                // Empty for clip frames
+        int trackId;
+        std::shared_ptr<Event> event; // Null while no event is open
+    };
+
+    struct StreamState
+    {
+        QString name;
+        int64_t nextSampleNs = 0; // Worker only
+        std::vector<Job> crops;   // Worker only; scratch for onFrame(), keeps its capacity
+        // Everything below, and the contents of event, is shared with the encoder
+        std::mutex mutex;
+        std::deque<EncodedFramePtr> ring;
+        std::shared_ptr<Event> event; // The open event, if any
+        int64_t lastFaceNs = 0;
+    };
+
+    struct Encoder
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Job> jobs;
+        bool stopping = false;
+    };
+
+    struct WriteTask
+    {
+        Event *finished;              // Set when the event is complete; owned by the task
+        std::shared_ptr<Event> event; // Set for an intermediate batch
+        std::vector<EncodedFramePtr> frames;
+        size_t bytes;
+    };
+
+    std::shared_ptr<Event> openEvent(StreamState &state, int64_t timeNs);
+    void submit(Job job);
+    void encoderLoop(Encoder *encoder);
+    void encode(Job &job);
+    void queueWrite(WriteTask task);
+    void finishEvent(Event *event);
+    void writerLoop();
+    void writeFrames(Event &event, const std::vector<EncodedFramePtr> &frames);
+    void writeMetadata(const Event &event);
+
+    RecorderSettings settings;
+    int64_t frameIntervalNs;
+    std::vector<std::unique_ptr<StreamState>> streams;
+    std::vector<std::unique_ptr<Encoder>> encoders;
+
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::deque<WriteTask> writes;
+    bool writerStopping;
+    std::atomic<size_t> backlogBytes;
+
+    std::atomic<uint64_t> clips;
+    std::atomic<uint64_t> shed;
+};
+
+#endif // EVENTRECORDER_H
@@ -0,0 +1,44 @@
+#ifndef FACEDETECTION_H
+#define FACEDETECTION_H
+
+#include <QString>
+#include <opencv2/core.hpp>
+
+// Optional analyses that run on a tracked face only when something asks for them
+enum FaceStage
+{
+    FaceStageLiveness = 0x1,
+    FaceStageMask = 0x2,
+    FaceStageAttribute = 0x4
+};
+
+// Results of the optional stages; stages says which fields are valid
+struct FaceAnalysis
+{
+    unsigned stages = 0;
+    float liveness = 0.0f; // RGB liveness confidence
+    float mask = 0.0f;     // Mask confidence
+    int race = -1;
+    int gender = -1;
+    int ageBracket = -1;
+};
+
+// One tracked face in source-frame coordinates
+struct FaceDetection
+{
+    int trackId = -1;
+    cv::Rect rect;
+    float confidence = 0.0f;
+    bool hasAngles = false;
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    float roll = 0.0f;
+    bool predicted = false; // Extrapolated between detections rather than measured
+    float quality = -1.0f;  // HFFaceQualityDetect score, < 0 when not measured
+    int identity = -1;      // FaceGallery index of the best match above threshold
+    QString name;           // Its gallery name; indices are only meaningful within one ModelSet
+    float matchScore = 0.0f;
+    FaceAnalysis analysis;
+};
+
+#endif // FACEDETECTION_H
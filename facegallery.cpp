@@ -0,0 +1,153 @@
+#include "facegallery.h"
+#include "similaritykernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <opencv2/core.hpp>
+
+namespace {
+
+// Copies a feature into a zero-padded, unit-length buffer
+bool normalise(const float *feature, int length, float *out, int stride)
+{
+    double norm = 0.0;
+    for (int i = 0; i < length; ++i) {
+        norm += double(feature[i]) * feature[i];
+    }
+    if (norm <= 0.0) return false;
+
+    const float inverse = float(1.0 / std::sqrt(norm));
+    for (int i = 0; i < length; ++i) {
+        out[i] = feature[i] * inverse;
+    }
+    std::fill(out + length, out + stride, 0.0f);
+    return true;
+}
+
+} // namespace
+
+FaceGallery::FaceGallery()
+    : dim(0)
+    , stride(0)
+    , rows(0)
+    , capacity(0)
+    , matrix(nullptr)
+    , index(new BruteForceIndex)
+{
+}
+
+FaceGallery::~FaceGallery()
+{
+    cv::fastFree(matrix);
+}
+
+const char *FaceGallery::kernelName()
+{
+    return similarityKernelName();
+}
+
+void FaceGallery::reset(int dimension)
+{
+    QWriteLocker locker(&lock);
+    cv::fastFree(matrix);
+    matrix = nullptr;
+    dim = std::max(0, dimension);
+    stride = (dim + 7) & ~7;
+    rows = 0;
+    capacity = 0;
+    names.clear();
+    removed.clear();
+    index->build(view());
+}
+
+int FaceGallery::size() const
+{
+    QReadLocker locker(&lock);
+    return rows;
+}
+
+QString FaceGallery::name(int identity) const
+{
+    QReadLocker locker(&lock);
+    return identity >= 0 && identity < names.size() ? names[identity] : QString();
+}
+
+void FaceGallery::reserve(int required)
+{
+    if (required <= capacity) return;
+
+    const int newCapacity = std::max(required, std::max(64, capacity * 2));
+    float *grown = static_cast<float *>(cv::fastMalloc(size_t(newCapacity) * stride * sizeof(float)));
+    if (matrix) {
+        std::memcpy(grown, matrix, size_t(rows) * stride * sizeof(float));
+        cv::fastFree(matrix);
+    }
+    matrix = grown;
+    capacity = newCapacity;
+}
+
+int FaceGallery::add(const QString &name, const float *feature, int length)
+{
+    QWriteLocker locker(&lock);
+    if (length != dim || dim == 0) return -1;
+
+    reserve(rows + 1);
+    if (!normalise(feature, length, matrix + size_t(rows) * stride, stride)) return -1;
+    names.append(name);
+    removed.push_back(0);
+    const int identity = rows++;
+    index->insert(view(), identity);
+    return identity;
+}
+
+bool FaceGallery::remove(int identity)
+{
+    QWriteLocker locker(&lock);
+    if (identity < 0 || identity >= rows || removed[identity]) return false;
+
+    removed[identity] = 1;
+    index->remove(view(), identity);
+    return true;
+}
+
+GalleryView FaceGallery::view() const
+{
+    GalleryView v;
+    v.matrix = matrix;
+    v.rows = rows;
+    v.stride = stride;
+    v.removed = removed.empty() ? nullptr : removed.data();
+    return v;
+}
+
+void FaceGallery::setIndex(std::unique_ptr<GalleryIndex> newIndex)
+{
+    QWriteLocker locker(&lock);
+    index = newIndex ? std::move(newIndex) : std::unique_ptr<GalleryIndex>(new BruteForceIndex);
+    index->build(view());
+}
+
+void FaceGallery::buildIndex()
+{
+    QWriteLocker locker(&lock);
+    index->build(view());
+}
+
+QString FaceGallery::indexName() const
+{
+    QReadLocker locker(&lock);
+    return QString::fromLatin1(index->name());
+}
+
+int FaceGallery::search(const float *query, int length, int k, GalleryMatch *out) const
+{
+    QReadLocker locker(&lock);
+    if (length != dim || rows == 0 || k <= 0) return 0;
+
+    // Per-thread scratch so concurrent searches never allocate in steady state
+    thread_local std::vector<float> normalised;
+    normalised.resize(stride);
+    if (!normalise(query, length, normalised.data(), stride)) return 0;
+
+    return index->search(view(), normalised.data(), k, out);
+}
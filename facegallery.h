@@ -0,0 +1,65 @@
+#ifndef FACEGALLERY_H
+#define FACEGALLERY_H
+
+#include "galleryindex.h"
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+// Enrolled face features stored as one contiguous, 32-byte aligned matrix of
+// unit-length rows, each padded to a multiple of 8 floats. search() goes
+// through a GalleryIndex: brute force by default (every row scored with
+// AVX2/FMA when the CPU has it), or an approximate index for large
+// watchlists. Searches may run concurrently from any number of workers;
+// enrollment and index changes take the write lock.
+class FaceGallery
+{
+public:
+    FaceGallery();
+    ~FaceGallery();
+
+    FaceGallery(const FaceGallery &) = delete;
+    FaceGallery &operator=(const FaceGallery &) = delete;
+
+    // Drops every identity and sets the feature length
+    void reset(int dimension);
+
+    int dimension() const { return dim; }
+    int size() const;
+    QString name(int identity) const;
+
+    // Returns the new identity index, or -1 if the feature length does not match
+    int add(const QString &name, const float *feature, int length);
+
+    // Hides an identity from search results; its index stays taken
+    bool remove(int identity);
+
+    // Fills out with up to k matches, best first; returns how many were written
+    int search(const float *query, int length, int k, GalleryMatch *out) const;
+
+    // Replaces the search index and builds it over the current rows
+    void setIndex(std::unique_ptr<GalleryIndex> index);
+    // Rebuilds the index, e.g. after many removals
+    void buildIndex();
+    QString indexName() const;
+
+    static const char *kernelName();
+
+private:
+    void reserve(int rows);
+    GalleryView view() const;
+
+    int dim;
+    int stride; // dim rounded up to 8 floats
+    int rows;
+    int capacity;
+    float *matrix;
+    QStringList names;
+    std::vector<char> removed;
+    std::unique_ptr<GalleryIndex> index;
+    mutable QReadWriteLock lock;
+};
+
+#endif // FACEGALLERY_H
@@ -0,0 +1,60 @@
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "facedetection.h"
+
+class FrameShelf;
+
+struct CapturedFrame
+{
+    cv::Mat image;
+    uint64_t sequence = 0;
+    int64_t captureTimeNs = 0; // steady_clock time when read() returned
+    bool keyFrame = false;     // Survives a full queue under KeepKeyFrames
+    std::vector<FaceDetection> faces; // Preview frames only: what the overlay draws; keeps its capacity
+    std::shared_ptr<FrameShelf> home; // The FramePool it returns to, empty for one-off frames
+};
+
+// Hands a frame back to its FramePool instead of freeing it
+struct FrameRecycler
+{
+    void operator()(CapturedFrame *frame) const;
+};
+
+typedef std::unique_ptr<CapturedFrame, FrameRecycler> FramePtr;
+
+// Single-slot hand-off between one producer and one consumer.
+// publish() always replaces whatever is in the slot, so the consumer only
+// ever sees the newest frame and never waits for the producer.
+class FrameMailbox
+{
+public:
+    FrameMailbox() : slot(nullptr) {}
+    ~FrameMailbox() { clear(); }
+
+    FrameMailbox(const FrameMailbox &) = delete;
+    FrameMailbox &operator=(const FrameMailbox &) = delete;
+
+    // Returns true if an unconsumed frame had to be dropped
+    bool publish(FramePtr frame)
+    {
+        FramePtr previous(slot.exchange(frame.release(), std::memory_order_acq_rel));
+        return previous != nullptr;
+    }
+
+    FramePtr take() { return FramePtr(slot.exchange(nullptr, std::memory_order_acq_rel)); }
+
+    void clear() { FramePtr(slot.exchange(nullptr, std::memory_order_acq_rel)); }
+
+    bool empty() const { return slot.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    std::atomic<CapturedFrame *> slot;
+};
+
+#endif // FRAMEMAILBOX_H
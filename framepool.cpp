@@ -0,0 +1,85 @@
+#include "framepool.h"
+#include <algorithm>
+
+void FrameRecycler::operator()(CapturedFrame *frame) const
+{
+    // Keep the shelf alive through put(); if this was its last reference it frees everything on it
+    std::shared_ptr<FrameShelf> home = std::move(frame->home);
+    if (!home) {
+        delete frame;
+        return;
+    }
+    // Dropping the pixels now lets FramePool::fill() see the buffer as free
+    frame->image.release();
+    frame->faces.clear();
+    home->put(frame);
+}
+
+FrameShelf::FrameShelf(size_t capacity)
+{
+    frames.reserve(capacity);
+}
+
+FrameShelf::~FrameShelf()
+{
+    for (CapturedFrame *frame : frames) {
+        delete frame;
+    }
+}
+
+void FrameShelf::put(CapturedFrame *frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frames.size() < frames.capacity()) {
+            frames.push_back(frame);
+            return;
+        }
+    }
+    delete frame;
+}
+
+CapturedFrame *FrameShelf::take()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frames.empty()) return nullptr;
+    CapturedFrame *frame = frames.back();
+    frames.pop_back();
+    return frame;
+}
+
+FramePool::FramePool(int capacity)
+    : capacity(size_t(std::max(1, capacity)))
+    , shelf(std::make_shared<FrameShelf>(size_t(std::max(1, capacity))))
+    , allocated(0)
+    , reused(0)
+{
+    buffers.reserve(this->capacity);
+}
+
+FramePtr FramePool::acquire()
+{
+    CapturedFrame *frame = shelf->take();
+    if (frame) {
+        frame->sequence = 0;
+        frame->captureTimeNs = 0;
+        frame->keyFrame = false;
+    } else {
+        frame = new CapturedFrame;
+    }
+    frame->home = shelf;
+    return FramePtr(frame);
+}
+
+cv::Mat *FramePool::freeBuffer()
+{
+    for (cv::Mat &buffer : buffers) {
+        // Consumers drop their references on other threads; read the count atomically
+        if (!buffer.u || CV_XADD(&buffer.u->refcount, 0) == 1) return &buffer;
+    }
+    if (buffers.size() < capacity) {
+        buffers.push_back(cv::Mat());
+        return &buffers.back();
+    }
+    return nullptr;
+}
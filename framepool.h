@@ -0,0 +1,83 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "framemailbox.h"
+
+// Where finished CapturedFrames wait to be reused. Shared by the pool and
+// every frame out in the pipeline, so a frame still queued or in a mailbox
+// when its capture thread is gone returns safely and is freed with the shelf.
+class FrameShelf
+{
+public:
+    explicit FrameShelf(size_t capacity);
+    ~FrameShelf();
+
+    FrameShelf(const FrameShelf &) = delete;
+    FrameShelf &operator=(const FrameShelf &) = delete;
+
+    // Deletes the frame instead when the shelf is full
+    void put(CapturedFrame *frame);
+    // nullptr when empty
+    CapturedFrame *take();
+
+private:
+    std::mutex mutex;
+    std::vector<CapturedFrame *> frames; // Reserved up front, so put() never allocates
+};
+
+// Frames and decode buffers of one capture thread. Frames go back onto the
+// pool's shelf when their last owner drops them (FramePtr's deleter), keeping
+// the capacity of their faces vector. Pixels are shared by reference between
+// the queue, the worker, the preview mailboxes and the recorder's encoder
+// jobs, so nobody hands a buffer back explicitly: a buffer is written again
+// only once cv::Mat's own reference count shows the pool is its last owner.
+// In steady state the frame loop then allocates nothing.
+class FramePool
+{
+public:
+    explicit FramePool(int capacity);
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    // A reset frame from the shelf, or a new one while the pool is filling up. Producer thread only.
+    FramePtr acquire();
+
+    // Lets read fill a free buffer and points image at it. When all capacity
+    // buffers are still referenced elsewhere the frame gets a buffer of its
+    // own, which is counted as an allocation. Producer thread only.
+    template <typename Read>
+    bool fill(cv::Mat &image, Read read)
+    {
+        cv::Mat scratch;
+        cv::Mat *buffer = freeBuffer();
+        cv::Mat &target = buffer ? *buffer : scratch;
+        const uchar *previous = target.data;
+        if (!read(target) || target.empty()) return false;
+        (target.data == previous ? reused : allocated).fetch_add(1, std::memory_order_relaxed);
+        image = target;
+        return true;
+    }
+
+    // Frames that needed a new buffer, including the first one of every slot and size changes
+    uint64_t allocations() const { return allocated.load(std::memory_order_relaxed); }
+    // Frames decoded into a recycled buffer
+    uint64_t reuses() const { return reused.load(std::memory_order_relaxed); }
+
+private:
+    cv::Mat *freeBuffer();
+
+    std::vector<cv::Mat> buffers; // Reserved up front, so pointers into it stay valid
+    size_t capacity;
+    std::shared_ptr<FrameShelf> shelf;
+    std::atomic<uint64_t> allocated;
+    std::atomic<uint64_t> reused;
+};
+
+#endif // FRAMEPOOL_H
@@ -0,0 +1,148 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "framemailbox.h"
+
+// What FrameQueue::publish() does when the queue is full
+enum FrameDropPolicy
+{
+    DropOldest,    // Evict the oldest queued frame; keeps latency lowest
+    DropNewest,    // Discard the incoming frame; keeps what is already queued
+    KeepKeyFrames  // Discard incoming ordinary frames, evict the oldest only for key frames
+};
+
+// Bounded frame queue between a capture thread and the engine workers,
+// after Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence
+// number, so push and pop each cost one CAS and never take a lock. The
+// producer pops as well when it evicts under DropOldest, which is why both
+// ends are multi-threaded. The algorithm needs at least two cells (with one,
+// a full and an empty cell look alike), so a capacity of 1 gets two cells
+// and the limit is enforced against the consumer position instead.
+class FrameQueue
+{
+public:
+    explicit FrameQueue(size_t capacity = 1, FrameDropPolicy policy = DropOldest)
+        : limit(capacity > 0 ? capacity : 1)
+        , cellCount(limit > 1 ? limit : 2)
+        , cells(new Cell[cellCount])
+        , policy(policy)
+        , enqueuePos(0)
+        , dequeuePos(0)
+        , dropped(0)
+    {
+        for (size_t i = 0; i < cellCount; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+            cells[i].frame = nullptr;
+        }
+    }
+    ~FrameQueue() { clear(); }
+
+    FrameQueue(const FrameQueue &) = delete;
+    FrameQueue &operator=(const FrameQueue &) = delete;
+
+    // Applies the drop policy when full. Returns true if a frame was dropped.
+    bool publish(FramePtr frame)
+    {
+        CapturedFrame *incoming = frame.release();
+        bool droppedAny = false;
+        while (!enqueue(incoming)) {
+            if (policy == DropNewest || (policy == KeepKeyFrames && !incoming->keyFrame)) {
+                FrameRecycler()(incoming);
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // A consumer racing us may have emptied the cell already; then just retry
+            if (CapturedFrame *oldest = dequeue()) {
+                FrameRecycler()(oldest);
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                droppedAny = true;
+            }
+        }
+        return droppedAny;
+    }
+
+    // Never drops; leaves frame untouched and returns false when full
+    bool tryPush(FramePtr &frame)
+    {
+        if (!enqueue(frame.get())) return false;
+        frame.release();
+        return true;
+    }
+
+    FramePtr take() { return FramePtr(dequeue()); }
+
+    void clear()
+    {
+        while (CapturedFrame *frame = dequeue()) FrameRecycler()(frame);
+    }
+
+    size_t capacity() const { return limit; }
+    uint64_t droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        CapturedFrame *frame;
+    };
+
+    bool enqueue(CapturedFrame *frame)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &cells[pos % cellCount];
+            const intptr_t diff = intptr_t(cell->sequence.load(std::memory_order_acquire)) - intptr_t(pos);
+            if (diff == 0) {
+                // Only a capacity of 1 has more cells than frames; a stale dequeuePos errs towards full
+                if (limit < cellCount && pos - dequeuePos.load(std::memory_order_acquire) >= limit) return false;
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->frame = frame;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    CapturedFrame *dequeue()
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &cells[pos % cellCount];
+            const intptr_t diff = intptr_t(cell->sequence.load(std::memory_order_acquire)) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return nullptr; // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        CapturedFrame *frame = cell->frame;
+        cell->sequence.store(pos + cellCount, std::memory_order_release);
+        return frame;
+    }
+
+    const size_t limit;     // Frames the queue holds
+    const size_t cellCount; // At least 2
+    std::unique_ptr<Cell[]> cells;
+    const FrameDropPolicy policy;
+    // Producer and consumer positions on separate cache lines. Padding rather
+    // than alignas keeps plain new usable without C++17 aligned allocation.
+    char padEnqueue[64];
+    std::atomic<size_t> enqueuePos;
+    char padDequeue[64];
+    std::atomic<size_t> dequeuePos;
+    std::atomic<uint64_t> dropped;
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,80 @@
+#include "galleryenrollment.h"
+#include "facegallery.h"
+#include "sessionpool.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+static QString identityName(const QString &filePath)
+{
+    QString name = QFileInfo(filePath).completeBaseName();
+    name.remove(QRegularExpression("_\\d+$"));
+    return name;
+}
+
+int enrollGalleryDirectory(FaceGallery &gallery, const QString &directory,
+                           const SessionSettings &settings, QString *errorMessage)
+{
+    QDir dir(directory);
+    if (!dir.exists()) {
+        if (errorMessage) *errorMessage = "Direktori galeri tidak ditemukan: " + directory;
+        return -1;
+    }
+
+    // Still images are unrelated to each other, so detect every time instead of tracking
+    SessionSettings enrollSettings = settings;
+    enrollSettings.detectMode = HF_DETECT_MODE_ALWAYS_DETECT;
+    HResult ret;
+    HFSession session = createSession(enrollSettings, &ret);
+    if (!session) {
+        if (errorMessage) *errorMessage = QString("Gagal membuat session enroll. Error code: %1").arg(ret);
+        return -1;
+    }
+
+    std::vector<float> feature(gallery.dimension());
+    int enrolled = 0;
+    const QStringList files = dir.entryList({"*.jpg", "*.jpeg", "*.png", "*.bmp"}, QDir::Files);
+    for (const QString &file : files) {
+        const QString path = dir.filePath(file);
+        cv::Mat image = cv::imread(path.toStdString(), cv::IMREAD_COLOR);
+        if (image.empty()) {
+            qDebug() << "Gagal membaca gambar galeri:" << path;
+            continue;
+        }
+
+        HFImageData imageData;
+        imageData.data = image.data;
+        imageData.width = image.cols;
+        imageData.height = image.rows;
+        imageData.format = HF_STREAM_BGR;
+        imageData.rotation = HF_CAMERA_ROTATION_0;
+
+        HFImageStream streamHandle;
+        if (HFCreateImageStream(&imageData, &streamHandle) != HSUCCEED) continue;
+
+        HFMultipleFaceData results;
+        if (HFExecuteFaceTrack(session, streamHandle, &results) == HSUCCEED && results.detectedNum > 0) {
+            // The largest face is the one the picture is about
+            int best = 0;
+            for (int i = 1; i < results.detectedNum; ++i) {
+                if (results.rects[i].width * results.rects[i].height >
+                    results.rects[best].width * results.rects[best].height) {
+                    best = i;
+                }
+            }
+            if (HFFaceFeatureExtractCpy(session, streamHandle, results.tokens[best], feature.data()) == HSUCCEED
+                && gallery.add(identityName(path), feature.data(), int(feature.size())) >= 0) {
+                ++enrolled;
+            }
+        } else {
+            qDebug() << "Tidak ada wajah di gambar galeri:" << path;
+        }
+        HFReleaseImageStream(streamHandle);
+    }
+
+    HFReleaseInspireFaceSession(session);
+    return enrolled;
+}
@@ -0,0 +1,16 @@
+#ifndef GALLERYENROLLMENT_H
+#define GALLERYENROLLMENT_H
+
+#include <QString>
+
+class FaceGallery;
+struct SessionSettings;
+
+// Enrolls the largest face of every image in directory. The identity name is
+// the file name without extension and without a trailing "_<number>", so
+// "Budi.jpg" and "Budi_2.jpg" both enroll as "Budi". Returns the number of
+// faces added, or -1 if the directory or the enrollment session is unusable.
+int enrollGalleryDirectory(FaceGallery &gallery, const QString &directory,
+                           const SessionSettings &settings, QString *errorMessage = nullptr);
+
+#endif // GALLERYENROLLMENT_H
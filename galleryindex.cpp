@@ -0,0 +1,49 @@
+#include "galleryindex.h"
+#include "hnswindex.h"
+#include "similaritykernels.h"
+#include <algorithm>
+
+namespace {
+
+// Rows are scored in blocks so the scores fit on the stack
+const int kBlockRows = 256;
+
+} // namespace
+
+int BruteForceIndex::search(const GalleryView &view, const float *query, int k, GalleryMatch *out) const
+{
+    int found = 0;
+    float scores[kBlockRows];
+    for (int first = 0; first < view.rows; first += kBlockRows) {
+        const int count = std::min(kBlockRows, view.rows - first);
+        dotRows(query, view.row(first), count, view.stride, scores);
+
+        // Insertion into a short sorted list; k is small so this beats a heap
+        for (int r = 0; r < count; ++r) {
+            const float score = scores[r];
+            if (found == k && score <= out[k - 1].score) continue;
+            if (view.isRemoved(first + r)) continue;
+
+            int position = found < k ? found++ : k - 1;
+            while (position > 0 && out[position - 1].score < score) {
+                out[position] = out[position - 1];
+                --position;
+            }
+            out[position].identity = first + r;
+            out[position].score = score;
+        }
+    }
+    return found;
+}
+
+std::unique_ptr<GalleryIndex> createGalleryIndex(const QJsonObject &config)
+{
+    if (config["type"].toString() == "hnsw") {
+        HnswIndex::Params params;
+        params.m = config["m"].toInt(params.m);
+        params.efConstruction = config["efConstruction"].toInt(params.efConstruction);
+        params.efSearch = config["efSearch"].toInt(params.efSearch);
+        return std::unique_ptr<GalleryIndex>(new HnswIndex(params));
+    }
+    return std::unique_ptr<GalleryIndex>(new BruteForceIndex);
+}
@@ -0,0 +1,62 @@
+#ifndef GALLERYINDEX_H
+#define GALLERYINDEX_H
+
+#include <QJsonObject>
+#include <memory>
+
+struct GalleryMatch
+{
+    int identity = -1;
+    float score = 0.0f; // Cosine similarity
+};
+
+// Read-only view of the gallery matrix handed to an index on every call;
+// the matrix may move when the gallery grows
+struct GalleryView
+{
+    const float *matrix = nullptr;
+    int rows = 0;
+    int stride = 0;               // Floats per row, a multiple of 8
+    const char *removed = nullptr; // removed[row] != 0 for deleted identities
+
+    const float *row(int index) const { return matrix + size_t(index) * stride; }
+    bool isRemoved(int index) const { return removed && removed[index]; }
+};
+
+// Search structure behind FaceGallery. Queries are unit length and zero
+// padded to the view's stride; scores are cosine similarities.
+class GalleryIndex
+{
+public:
+    virtual ~GalleryIndex() {}
+
+    virtual const char *name() const = 0;
+
+    // Rebuilds the structure from every row in the view
+    virtual void build(const GalleryView &view) = 0;
+    // Row id has just been appended to the view
+    virtual void insert(const GalleryView &view, int id) = 0;
+    // Row id is marked removed in the view
+    virtual void remove(const GalleryView &view, int id) = 0;
+
+    virtual int search(const GalleryView &view, const float *query, int k, GalleryMatch *out) const = 0;
+};
+
+// Exact search: scores every row. This is the baseline the approximate
+// indexes are measured against.
+class BruteForceIndex : public GalleryIndex
+{
+public:
+    const char *name() const override { return "bruteforce"; }
+    void build(const GalleryView &) override {}
+    void insert(const GalleryView &, int) override {}
+    void remove(const GalleryView &, int) override {}
+    int search(const GalleryView &view, const float *query, int k, GalleryMatch *out) const override;
+};
+
+// Creates the index described by the "galleryIndex" object in streams.json,
+// e.g. {"type": "hnsw", "m": 16, "efConstruction": 200, "efSearch": 64}.
+// Unknown or missing types fall back to brute force.
+std::unique_ptr<GalleryIndex> createGalleryIndex(const QJsonObject &config);
+
+#endif // GALLERYINDEX_H
@@ -0,0 +1,23 @@
+# Headless daemon: the same processing core as FaceRec.pro without any
+# widget, pixmap or overlay work. Results go to stdout as JSON lines.
+QT += core
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = facerecd
+
+include(../core.pri)
+
+HEADERS += \
+    resultwriter.h
+
+SOURCES += \
+    main.cpp \
+    resultwriter.cpp
+
+# Default rules for deployment.
+unix:!android: target.path = /opt/facerec/bin
+!isEmpty(target.path): INSTALLS += target
+
+unix: QMAKE_RPATHDIR += $$PWD/../InspireFace/lib
@@ -0,0 +1,188 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include "engineconfig.h"
+#include "eventrecorder.h"
+#include "modelmanager.h"
+#include "resultwriter.h"
+#include "sightingslog.h"
+#include "streamconfig.h"
+#include "streamengine.h"
+
+// Set from the signal handler; polled by a timer on the main thread
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("facerecd");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Deteksi dan pengenalan wajah tanpa GUI; hasil ditulis sebagai JSON per baris");
+    parser.addHelpOption();
+    QCommandLineOption configOption(QStringList() << "c" << "config", "File konfigurasi", "file", "streams.json");
+    QCommandLineOption modelOption(QStringList() << "m" << "model", "File model InspireFace (default: modelPath/modelName)", "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "File hasil (default: stdout)", "file");
+    QCommandLineOption predictedOption("predicted", "Tulis juga frame yang kotaknya diekstrapolasi");
+    QCommandLineOption metricsOption("metrics", "Tulis histogram latensi per tahap ke file ini secara berkala", "file");
+    QCommandLineOption metricsIntervalOption("metrics-interval", "Interval penulisan metrics (detik)", "seconds", "10");
+    parser.addOption(configOption);
+    parser.addOption(modelOption);
+    parser.addOption(outputOption);
+    parser.addOption(predictedOption);
+    parser.addOption(metricsOption);
+    parser.addOption(metricsIntervalOption);
+    parser.process(app);
+
+    QFile file(parser.value(configOption));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Tidak dapat membuka file" << file.fileName();
+        return 1;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    const EngineConfig engineConfig = EngineConfig::fromJson(root);
+    QVector<StreamConfig> configs;
+    QStringList names;
+    const QJsonArray streams = root["streams"].toArray();
+    for (int i = 0; i < streams.size(); ++i) {
+        StreamConfig config = StreamConfig::fromJson(streams[i].toObject());
+        if (!config.enabled || config.url.isEmpty()) continue;
+        configs.append(config);
+        names.append(config.name.isEmpty() ? config.url : config.name);
+    }
+    if (configs.isEmpty()) {
+        qCritical() << "Tidak ada stream aktif di" << file.fileName();
+        return 1;
+    }
+
+    const QString modelFile = parser.isSet(modelOption) ? parser.value(modelOption) : engineConfig.modelFile();
+    if (!parser.isSet(modelOption) && engineConfig.modelName.isEmpty()) {
+        qCritical() << "Model belum dipilih: isi modelName di konfigurasi atau gunakan --model";
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (parser.isSet(outputOption)) {
+        out = std::fopen(parser.value(outputOption).toLocal8Bit().constData(), "a");
+        if (!out) {
+            qCritical() << "Tidak dapat membuka file hasil" << parser.value(outputOption);
+            return 1;
+        }
+    }
+
+    ModelManager models;
+    QString error;
+    QString warning;
+    const int poolSize = std::max(QThread::idealThreadCount(), int(configs.size()));
+    models.setWarmUpSizes(ModelManager::warmUpSizes(configs));
+    if (!models.load(modelFile, engineConfig, poolSize, &error, &warning)) {
+        qCritical() << error;
+        return 1;
+    }
+    if (!warning.isEmpty()) {
+        qWarning() << warning;
+    }
+    qDebug() << "Model siap dalam" << qRound(models.loadMs()) << "ms, termasuk pemanasan"
+             << qRound(models.warmUpMs()) << "ms";
+
+    ResultWriter writer(out, names, parser.isSet(predictedOption));
+    EventRecorder recorder;
+    recorder.setSettings(RecorderSettings::fromJson(engineConfig.recording));
+    SightingsLog sightings;
+    sightings.setDirectory(engineConfig.sightingsPath);
+    StreamEngine engine;
+    models.configure(engine);
+    engine.setRecorder(&recorder);
+    engine.setSightingsLog(&sightings);
+    engine.setPreviewPaused(true);
+    engine.setResultCallback([&writer](int index, const CapturedFrame &frame,
+                                       const std::vector<FaceDetection> &faces, bool detected) {
+        writer.write(index, frame, faces, detected);
+    });
+
+    // A dead camera is only fatal once no stream is left
+    QObject::connect(&engine, &StreamEngine::streamOpenFailed, [&](int index, const QString &url) {
+        qWarning() << "Stream" << names[index] << "tidak dapat dibuka:" << url;
+        if (engine.liveStreamCount() == 0) app.exit(1);
+    });
+    QObject::connect(&engine, &StreamEngine::streamConnectionLost, [&](int index, const QString &message) {
+        qWarning() << "Stream" << names[index] << "terputus:" << message;
+        if (engine.liveStreamCount() == 0) app.exit(1);
+    });
+    QObject::connect(&engine, &StreamEngine::streamStateChanged, [&](int index, int state, int attempt, int delayMs) {
+        if (state == CaptureThread::BackingOff) {
+            qWarning() << "Stream" << names[index] << "mencoba ulang dalam" << delayMs << "ms, percobaan" << attempt + 1;
+        } else if (state == CaptureThread::Live) {
+            qDebug() << "Stream" << names[index] << "terhubung";
+        }
+    });
+
+    QObject::connect(&engine, &StreamEngine::streamEnded, [&](int index) {
+        qDebug() << "Stream" << names[index] << "selesai diputar";
+        if (engine.liveStreamCount() == 0) app.exit(0);
+    });
+
+    if (!engine.start(configs, models.models(), &error)) {
+        qCritical() << error;
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    QTimer stopTimer;
+    QObject::connect(&stopTimer, &QTimer::timeout, [&app]() {
+        if (stopRequested) app.quit();
+    });
+    stopTimer.start(200);
+
+    QTimer metricsTimer;
+    const QString metricsPath = parser.value(metricsOption);
+    if (!metricsPath.isEmpty()) {
+        QObject::connect(&metricsTimer, &QTimer::timeout, [&engine, &metricsPath]() {
+            QString metricsError;
+            if (!writeMetricsJson(metricsPath, engine.metricsSnapshot(), &metricsError)) {
+                qWarning() << metricsError;
+            }
+        });
+        metricsTimer.start(std::max(1, parser.value(metricsIntervalOption).toInt()) * 1000);
+    }
+
+    const int exitCode = app.exec();
+
+    const std::vector<PipelineMetricsSnapshot> finalMetrics = engine.metricsSnapshot();
+    if (!metricsPath.isEmpty()) {
+        writeMetricsJson(metricsPath, finalMetrics);
+    }
+    engine.stop();
+    logStartupMetrics(finalMetrics);
+    qDebug() << "Ekstraksi fitur:" << engine.featureExtractions()
+             << "dijalankan," << engine.reusedEmbeddings() << "memakai cache track;"
+             << writer.linesWritten() << "baris hasil;"
+             << engine.motionSkippedFrames() << "deteksi dilewati karena scene statis";
+    if (recorder.enabled()) {
+        qDebug() << "Rekaman:" << recorder.clipsWritten() << "klip ditulis,"
+                 << recorder.shedFrames() << "frame dilewati karena encoder atau disk tertinggal";
+    }
+    if (sightings.enabled()) {
+        qDebug() << "Sightings ditulis:" << sightings.sightingsWritten();
+    }
+    models.unload();
+    if (out != stdout) std::fclose(out);
+    return exitCode;
+}
@@ -0,0 +1,62 @@
+#include "resultwriter.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+ResultWriter::ResultWriter(FILE *output, const QStringList &names, bool predicted)
+    : out(output)
+    , streamNames(names)
+    , includePredicted(predicted)
+    , lastFaceCount(names.size(), 0)
+    , lines(0)
+{
+}
+
+void ResultWriter::write(int index, const CapturedFrame &frame, const std::vector<FaceDetection> &faces,
+                         bool detected)
+{
+    if (!detected && !includePredicted) return;
+    if (index < 0 || index >= int(lastFaceCount.size())) return;
+
+    const int previousCount = lastFaceCount[index];
+    lastFaceCount[index] = int(faces.size());
+    if (faces.empty() && previousCount == 0) return;
+
+    QJsonArray faceArray;
+    for (const FaceDetection &face : faces) {
+        QJsonObject item;
+        item["trackId"] = face.trackId;
+        item["x"] = face.rect.x;
+        item["y"] = face.rect.y;
+        item["width"] = face.rect.width;
+        item["height"] = face.rect.height;
+        item["confidence"] = double(face.confidence);
+        if (face.quality >= 0.0f) item["quality"] = double(face.quality);
+        if (face.identity >= 0) {
+            item["identity"] = face.name;
+            item["score"] = double(face.matchScore);
+        }
+        if (face.analysis.stages & FaceStageLiveness) item["liveness"] = double(face.analysis.liveness);
+        if (face.analysis.stages & FaceStageMask) item["mask"] = double(face.analysis.mask);
+        if (face.analysis.stages & FaceStageAttribute) {
+            item["gender"] = face.analysis.gender;
+            item["ageBracket"] = face.analysis.ageBracket;
+            item["race"] = face.analysis.race;
+        }
+        faceArray.append(item);
+    }
+
+    QJsonObject line;
+    line["stream"] = streamNames[index];
+    line["sequence"] = double(frame.sequence);
+    line["timeNs"] = double(frame.captureTimeNs);
+    line["detected"] = detected;
+    line["faces"] = faceArray;
+    const QByteArray json = QJsonDocument(line).toJson(QJsonDocument::Compact);
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::fwrite(json.constData(), 1, size_t(json.size()), out);
+    std::fputc('\n', out);
+    std::fflush(out);
+    ++lines;
+}
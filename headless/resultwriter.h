@@ -0,0 +1,33 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <QStringList>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "facedetection.h"
+#include "framemailbox.h"
+
+// Writes one JSON object per line for every frame with faces, plus one for
+// the frame where a stream's last face disappears. Safe to call from every
+// engine worker at once.
+class ResultWriter
+{
+public:
+    ResultWriter(FILE *out, const QStringList &streamNames, bool includePredicted);
+
+    void write(int index, const CapturedFrame &frame, const std::vector<FaceDetection> &faces,
+               bool detected);
+
+    uint64_t linesWritten() const { return lines; }
+
+private:
+    FILE *out;
+    QStringList streamNames;
+    bool includePredicted;
+    std::vector<int> lastFaceCount; // Per stream; only touched by the worker holding that stream
+    std::mutex outputMutex;
+    uint64_t lines;
+};
+
+#endif // RESULTWRITER_H
@@ -0,0 +1,264 @@
+#include "hnswindex.h"
+#include "similaritykernels.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Per-thread visited marks; bumping the tag clears them without touching memory
+struct VisitedList
+{
+    std::vector<unsigned> marks;
+    unsigned tag = 0;
+
+    void begin(int size)
+    {
+        if (int(marks.size()) < size) marks.resize(size, 0);
+        if (++tag == 0) {
+            std::fill(marks.begin(), marks.end(), 0u);
+            tag = 1;
+        }
+    }
+
+    bool visit(int id)
+    {
+        if (marks[id] == tag) return false;
+        marks[id] = tag;
+        return true;
+    }
+};
+
+thread_local VisitedList visited;
+
+inline float distance(const GalleryView &view, const float *query, int id)
+{
+    return 1.0f - dotProduct(query, view.row(id), view.stride);
+}
+
+} // namespace
+
+HnswIndex::HnswIndex()
+    : HnswIndex(Params())
+{
+}
+
+HnswIndex::HnswIndex(const Params &p)
+    : params(p)
+    , random(100)
+    , entryPoint(-1)
+    , maxLevel(-1)
+{
+    params.m = std::max(2, params.m);
+    params.efConstruction = std::max(params.m, params.efConstruction);
+    params.efSearch = std::max(1, params.efSearch);
+    levelScale = 1.0 / std::log(double(params.m));
+}
+
+int *HnswIndex::links(int id, int level)
+{
+    if (level == 0) return level0.data() + size_t(id) * (2 * params.m + 1);
+    return upperLinks[id].data() + size_t(level - 1) * (params.m + 1);
+}
+
+const int *HnswIndex::links(int id, int level) const
+{
+    return const_cast<HnswIndex *>(this)->links(id, level);
+}
+
+int HnswIndex::randomLevel()
+{
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double u = std::max(uniform(random), 1e-12);
+    return int(-std::log(u) * levelScale);
+}
+
+void HnswIndex::build(const GalleryView &view)
+{
+    entryPoint = -1;
+    maxLevel = -1;
+    levels.assign(view.rows, -1);
+    level0.assign(size_t(view.rows) * (2 * params.m + 1), 0);
+    upperLinks.assign(view.rows, std::vector<int>());
+    random.seed(100);
+
+    for (int id = 0; id < view.rows; ++id) {
+        if (!view.isRemoved(id)) insert(view, id);
+    }
+}
+
+int HnswIndex::greedyDescend(const GalleryView &view, const float *query, int entry, int fromLevel, int toLevel) const
+{
+    int current = entry;
+    float best = distance(view, query, current);
+    for (int level = fromLevel; level > toLevel; --level) {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            const int *list = links(current, level);
+            for (int i = 1; i <= list[0]; ++i) {
+                const float d = distance(view, query, list[i]);
+                if (d < best) {
+                    best = d;
+                    current = list[i];
+                    improved = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+void HnswIndex::searchLayer(const GalleryView &view, const float *query, int entry, int ef, int level,
+                            bool skipRemoved, std::vector<Candidate> &result) const
+{
+    // candidates: closest first; nearest: worst of the kept ef on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::priority_queue<Candidate> nearest;
+
+    visited.begin(int(levels.size()));
+    visited.visit(entry);
+    const float entryDistance = distance(view, query, entry);
+    candidates.push(Candidate(entryDistance, entry));
+    if (!skipRemoved || !view.isRemoved(entry)) nearest.push(Candidate(entryDistance, entry));
+    float bound = nearest.empty() ? 2.0f : nearest.top().first;
+
+    while (!candidates.empty()) {
+        const Candidate current = candidates.top();
+        if (current.first > bound && int(nearest.size()) >= ef) break;
+        candidates.pop();
+
+        const int *list = links(current.second, level);
+        for (int i = 1; i <= list[0]; ++i) {
+            const int neighbour = list[i];
+            if (!visited.visit(neighbour)) continue;
+
+            const float d = distance(view, query, neighbour);
+            if (int(nearest.size()) < ef || d < bound) {
+                candidates.push(Candidate(d, neighbour));
+                if (skipRemoved && view.isRemoved(neighbour)) continue;
+                nearest.push(Candidate(d, neighbour));
+                if (int(nearest.size()) > ef) nearest.pop();
+                bound = nearest.top().first;
+            }
+        }
+    }
+
+    result.resize(nearest.size());
+    for (int i = int(nearest.size()) - 1; i >= 0; --i) {
+        result[i] = nearest.top();
+        nearest.pop();
+    }
+}
+
+void HnswIndex::selectNeighbours(const GalleryView &view, std::vector<Candidate> &candidates, int count) const
+{
+    // Keeps a candidate only if it is closer to the base than to every
+    // neighbour already kept, which spreads links across directions
+    std::sort(candidates.begin(), candidates.end());
+    if (int(candidates.size()) <= count) return;
+
+    std::vector<Candidate> selected;
+    selected.reserve(count);
+    for (const Candidate &candidate : candidates) {
+        if (int(selected.size()) >= count) break;
+        const float *row = view.row(candidate.second);
+        bool keep = true;
+        for (const Candidate &kept : selected) {
+            if (distance(view, row, kept.second) < candidate.first) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) selected.push_back(candidate);
+    }
+    candidates.swap(selected);
+}
+
+void HnswIndex::connect(const GalleryView &view, int id, int neighbour, int level)
+{
+    int *list = links(neighbour, level);
+    const int limit = maxLinks(level);
+    if (list[0] < limit) {
+        list[++list[0]] = id;
+        return;
+    }
+
+    // Full: re-select the neighbour's links from its current set plus the new node
+    const float *row = view.row(neighbour);
+    std::vector<Candidate> candidates;
+    candidates.reserve(limit + 1);
+    candidates.push_back(Candidate(distance(view, row, id), id));
+    for (int i = 1; i <= list[0]; ++i) {
+        candidates.push_back(Candidate(distance(view, row, list[i]), list[i]));
+    }
+    selectNeighbours(view, candidates, limit);
+    list[0] = int(candidates.size());
+    for (int i = 0; i < list[0]; ++i) {
+        list[i + 1] = candidates[i].second;
+    }
+}
+
+void HnswIndex::insert(const GalleryView &view, int id)
+{
+    if (id >= int(levels.size())) {
+        const size_t size = std::max<size_t>(size_t(id) + 1, levels.size() * 2);
+        levels.resize(size, -1);
+        level0.resize(size * (2 * params.m + 1), 0);
+        upperLinks.resize(size);
+    }
+
+    const int level = randomLevel();
+    levels[id] = level;
+    links(id, 0)[0] = 0;
+    upperLinks[id].assign(size_t(level) * (params.m + 1), 0);
+
+    if (entryPoint < 0) {
+        entryPoint = id;
+        maxLevel = level;
+        return;
+    }
+
+    const float *query = view.row(id);
+    int entry = greedyDescend(view, query, entryPoint, maxLevel, level);
+
+    std::vector<Candidate> candidates;
+    for (int l = std::min(level, maxLevel); l >= 0; --l) {
+        searchLayer(view, query, entry, params.efConstruction, l, false, candidates);
+        entry = candidates.front().second;
+
+        selectNeighbours(view, candidates, params.m);
+        int *list = links(id, l);
+        list[0] = int(candidates.size());
+        for (int i = 0; i < list[0]; ++i) {
+            list[i + 1] = candidates[i].second;
+            connect(view, id, candidates[i].second, l);
+        }
+    }
+
+    if (level > maxLevel) {
+        entryPoint = id;
+        maxLevel = level;
+    }
+}
+
+void HnswIndex::remove(const GalleryView &, int)
+{
+    // The view's removed flags are the tombstones; nothing to unlink
+}
+
+int HnswIndex::search(const GalleryView &view, const float *query, int k, GalleryMatch *out) const
+{
+    if (entryPoint < 0) return 0;
+
+    const int entry = greedyDescend(view, query, entryPoint, maxLevel, 0);
+    thread_local std::vector<Candidate> nearest;
+    searchLayer(view, query, entry, std::max(params.efSearch, k), 0, true, nearest);
+
+    const int found = std::min(k, int(nearest.size()));
+    for (int i = 0; i < found; ++i) {
+        out[i].identity = nearest[i].second;
+        out[i].score = 1.0f - nearest[i].first;
+    }
+    return found;
+}
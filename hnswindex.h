@@ -0,0 +1,61 @@
+#ifndef HNSWINDEX_H
+#define HNSWINDEX_H
+
+#include "galleryindex.h"
+#include <random>
+#include <vector>
+
+// Hierarchical navigable small world graph (Malkov & Yashunin) over the
+// gallery rows. Node ids are gallery row indices, so the graph stores links
+// only and reads vectors straight from the view. Removal is a tombstone:
+// removed rows still route searches but are never returned; build() drops
+// them from the graph.
+class HnswIndex : public GalleryIndex
+{
+public:
+    struct Params
+    {
+        int m = 16;               // Links per node above level 0 (2m at level 0)
+        int efConstruction = 200; // Candidate list size while inserting
+        int efSearch = 64;        // Candidate list size while searching; raises recall and latency
+    };
+
+    HnswIndex();
+    explicit HnswIndex(const Params &params);
+
+    const char *name() const override { return "hnsw"; }
+    void build(const GalleryView &view) override;
+    void insert(const GalleryView &view, int id) override;
+    void remove(const GalleryView &view, int id) override;
+    int search(const GalleryView &view, const float *query, int k, GalleryMatch *out) const override;
+
+    // Not thread safe against concurrent searches; set it under the gallery write lock
+    void setEfSearch(int ef) { params.efSearch = ef > 0 ? ef : 1; }
+    const Params &parameters() const { return params; }
+
+private:
+    typedef std::pair<float, int> Candidate; // (distance, id)
+
+    int *links(int id, int level);
+    const int *links(int id, int level) const;
+    int maxLinks(int level) const { return level == 0 ? 2 * params.m : params.m; }
+    int randomLevel();
+
+    int greedyDescend(const GalleryView &view, const float *query, int entry, int fromLevel, int toLevel) const;
+    void searchLayer(const GalleryView &view, const float *query, int entry, int ef, int level,
+                     bool skipRemoved, std::vector<Candidate> &result) const;
+    void selectNeighbours(const GalleryView &view, std::vector<Candidate> &candidates, int count) const;
+    void connect(const GalleryView &view, int id, int neighbour, int level);
+
+    Params params;
+    double levelScale;
+    std::mt19937 random;
+
+    int entryPoint;
+    int maxLevel;
+    std::vector<int> levels;                    // Top level per node, -1 if not in the graph
+    std::vector<int> level0;                    // Per node: count followed by 2m links
+    std::vector<std::vector<int>> upperLinks;   // Per node: (count + m links) for levels 1..top
+};
+
+#endif // HNSWINDEX_H
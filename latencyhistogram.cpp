@@ -0,0 +1,76 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <chrono>
+
+LatencyHistogram::LatencyHistogram()
+    : sumNs(0)
+    , maxNs(0)
+{
+    for (std::atomic<uint64_t> &bucket : counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t LatencyHistogram::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < SubBuckets) return int(value);
+
+    const int exponent = 63 - int(qCountLeadingZeroBits(quint64(value)));
+    if (exponent > MaxExponent) return BucketCount - 1;
+    const int sub = int(value >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+    return SubBuckets + (exponent - SubBucketBits) * SubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < SubBuckets) return uint64_t(bucket);
+
+    const int exponent = (bucket - SubBuckets) / SubBuckets + SubBucketBits;
+    const int sub = (bucket - SubBuckets) % SubBuckets;
+    const uint64_t width = uint64_t(1) << (exponent - SubBucketBits);
+    return (uint64_t(SubBuckets + sub) << (exponent - SubBucketBits)) + width - 1;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    result.counts.resize(BucketCount);
+    for (int i = 0; i < BucketCount; ++i) {
+        result.counts[i] = counts[i].load(std::memory_order_relaxed);
+        result.count += result.counts[i];
+    }
+    result.sumNs = sumNs.load(std::memory_order_relaxed);
+    result.maxNs = maxNs.load(std::memory_order_relaxed);
+    return result;
+}
+
+double LatencyHistogram::Snapshot::percentileMs(double p) const
+{
+    if (count == 0) return 0.0;
+
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(p * count + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < int(counts.size()); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucketUpperBound(i), maxNs) / 1e6;
+    }
+    return maxMs();
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot &other)
+{
+    if (counts.size() < other.counts.size()) counts.resize(other.counts.size(), 0);
+    for (size_t i = 0; i < other.counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sumNs += other.sumNs;
+    maxNs = std::max(maxNs, other.maxNs);
+}
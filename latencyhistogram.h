@@ -0,0 +1,67 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Log-linear (HDR-style) histogram of nanosecond durations: 16 sub-buckets
+// per power of two, so any recorded value is off by at most 6.25%, from
+// 1 ns up to about 36 minutes. record() is a handful of relaxed loads and
+// stores with no lock prefix, which is only correct with a single writer;
+// every histogram here belongs to one stream stage and is written by the
+// one thread working that stream. Any thread may take a snapshot at any
+// time; it can be a few samples behind, but never torn.
+class LatencyHistogram
+{
+public:
+    enum { SubBucketBits = 4, SubBuckets = 1 << SubBucketBits, MaxExponent = 40 };
+    enum { BucketCount = SubBuckets + (MaxExponent - SubBucketBits + 1) * SubBuckets };
+
+    struct Snapshot
+    {
+        std::vector<uint64_t> counts;
+        uint64_t count = 0;
+        uint64_t sumNs = 0;
+        uint64_t maxNs = 0;
+
+        double meanMs() const { return count ? sumNs / 1e6 / count : 0.0; }
+        double maxMs() const { return maxNs / 1e6; }
+        // Upper bound of the bucket holding the p-th fraction of samples
+        double percentileMs(double p) const;
+        void merge(const Snapshot &other);
+    };
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void record(int64_t ns)
+    {
+        const uint64_t value = ns > 0 ? uint64_t(ns) : 0;
+        bump(counts[bucketOf(value)], 1);
+        bump(sumNs, value);
+        if (value > maxNs.load(std::memory_order_relaxed)) maxNs.store(value, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const;
+
+    // steady_clock in nanoseconds, the time base of every recorded duration
+    static int64_t nowNs();
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(int bucket);
+
+private:
+    static void bump(std::atomic<uint64_t> &counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts[BucketCount];
+    std::atomic<uint64_t> sumNs;
+    std::atomic<uint64_t> maxNs;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "streamconfig.h"
 #include <QMessageBox>
 #include <QTimer>
 #include <QImage>
@@ -10,28 +11,48 @@
 #include <QFileDialog>
 #include <QDir>
 #include <QFileInfo>
+#include <QThread>
+#include <QScreen>
+#include <QGuiApplication>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , videoCapture(nullptr)
-    , timer(new QTimer(this))
+    , engine(new StreamEngine(this))
+    , renderTimer(new QTimer(this))
+    , renderFpsCap(0)
+    , metricsTimer(new QTimer(this))
     , isRunning(false)
     , isModelLoaded(false)
+    , isModelLoading(false)
+    , streamModel(new StreamTableModel(&streamRegistry, this))
+    , configWriter("streams.json")
+    , modelLoader(new ModelLoader(&models, this))
 {
     setupUI();
-    connect(timer, &QTimer::timeout, this, &MainWindow::updateFrame);
+    connect(modelLoader, &ModelLoader::progress, this, &MainWindow::onModelLoadProgress);
+    connect(modelLoader, &QThread::finished, this, &MainWindow::onModelLoaded);
+    renderTimer->setTimerType(Qt::PreciseTimer);
+    connect(renderTimer, &QTimer::timeout, this, &MainWindow::renderFrame);
+    connect(metricsTimer, &QTimer::timeout, this, &MainWindow::updateMetrics);
+    connect(engine, &StreamEngine::streamOpenFailed, this, &MainWindow::onStreamOpenFailed);
+    connect(engine, &StreamEngine::streamConnectionLost, this, &MainWindow::onStreamConnectionLost);
+    connect(engine, &StreamEngine::streamEnded, this, &MainWindow::onStreamEnded);
+    connect(engine, &StreamEngine::streamStateChanged, this, &MainWindow::onStreamStateChanged);
+    engine->setRecorder(&recorder);
+    engine->setSightingsLog(&sightings);
     loadStreams();
+    connect(streamModel, &StreamTableModel::streamsChanged, this, &MainWindow::saveStreams);
 }
 
 MainWindow::~MainWindow()
 {
+    // A load in flight still owns models
+    modelLoader->wait();
     stopFaceDetection();
     unloadModel();
-    if (videoCapture) {
-        videoCapture->release();
-        delete videoCapture;
-    }
     saveStreams();
+    configWriter.flush();
 }
 
 void MainWindow::setupUI()
@@ -72,15 +93,26 @@ void MainWindow::setupUI()
     connect(modelListWidget, &QListWidget::itemSelectionChanged,
             this, &MainWindow::onModelSelectionChanged);
 
+    modelProgress = new QProgressBar(this);
+    modelProgress->setRange(0, 100);
+    modelProgress->hide();
+
     loadModelButton = new QPushButton("Load Selected Model", this);
     loadModelButton->setEnabled(false);
     connect(modelPathButton, &QPushButton::clicked, this, &MainWindow::onModelPathButtonClicked);
     connect(loadModelButton, &QPushButton::clicked, this, &MainWindow::onLoadModelClicked);
 
+    // Loads the selected pack next to the current one; running streams move over without stopping
+    swapModelButton = new QPushButton("Ganti Model", this);
+    swapModelButton->setEnabled(false);
+    connect(swapModelButton, &QPushButton::clicked, this, &MainWindow::onSwapModelClicked);
+
     modelLayout->addLayout(modelPathLayout);
     modelLayout->addWidget(new QLabel("Available Models:", this));
     modelLayout->addWidget(modelListWidget);
+    modelLayout->addWidget(modelProgress);
     modelLayout->addWidget(loadModelButton);
+    modelLayout->addWidget(swapModelButton);
 
     // Control Group
     controlGroup = new QGroupBox("Control", this);
@@ -93,11 +125,20 @@ void MainWindow::setupUI()
     connect(sourceComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onSourceChanged);
 
-    // Stream selection
+    // Stream selection, fed by the same model as the stream table
     streamComboBox = new QComboBox(this);
+    streamComboBox->setModel(streamModel);
+    streamComboBox->setModelColumn(StreamTableModel::NameColumn);
     connect(streamComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onStreamSelected);
 
+    // Single preview or a mosaic of every running stream
+    viewComboBox = new QComboBox(this);
+    viewComboBox->addItem("Satu stream");
+    viewComboBox->addItem("Mosaik");
+    connect(viewComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onViewChanged);
+
     // RTSP URL input
     rtspUrlEdit = new QLineEdit(this);
     rtspUrlEdit->setPlaceholderText("rtsp://username:password@ip:port/stream");
@@ -114,6 +155,7 @@ void MainWindow::setupUI()
     controlLayout->addWidget(new QLabel("Source:", this));
     controlLayout->addWidget(sourceComboBox);
     controlLayout->addWidget(streamComboBox);
+    controlLayout->addWidget(viewComboBox);
     controlLayout->addWidget(rtspUrlEdit);
     controlLayout->addWidget(startButton);
     controlLayout->addWidget(stopButton);
@@ -121,10 +163,12 @@ void MainWindow::setupUI()
     // Video Group
     videoGroup = new QGroupBox("Video", this);
     QVBoxLayout *videoLayout = new QVBoxLayout(videoGroup);
-    videoLabel = new QLabel(this);
-    videoLabel->setAlignment(Qt::AlignCenter);
-    videoLabel->setMinimumSize(640, 480);
-    videoLayout->addWidget(videoLabel);
+    videoView = new VideoView(this);
+    videoView->setMinimumSize(640, 480);
+    videoLayout->addWidget(videoView);
+    mosaicView = new MosaicView(this);
+    mosaicView->hide();
+    videoLayout->addWidget(mosaicView);
 
     // Add groups to video tab layout
     videoTabLayout->addWidget(modelGroup);
@@ -140,12 +184,12 @@ void MainWindow::setupUI()
     QVBoxLayout *streamLayout = new QVBoxLayout(streamGroup);
 
     // Stream table
-    streamTable = new QTableWidget(this);
-    streamTable->setColumnCount(2);
-    streamTable->setHorizontalHeaderLabels({"Name", "URL"});
+    streamTable = new QTableView(this);
+    streamTable->setModel(streamModel);
     streamTable->horizontalHeader()->setStretchLastSection(true);
+    // Fixed row heights let the view lay out thousands of rows without measuring them
+    streamTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     streamTable->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
-    connect(streamTable, &QTableWidget::cellChanged, this, &MainWindow::onStreamTableChanged);
 
     // Stream input fields
     QHBoxLayout *streamInputLayout = new QHBoxLayout();
@@ -170,19 +214,25 @@ void MainWindow::setupUI()
     // Add groups to stream tab layout
     streamTabLayout->addWidget(streamGroup);
 
+    // Create metrics tab: per-stream, per-stage latency histograms
+    QWidget *metricsTab = new QWidget(this);
+    QVBoxLayout *metricsTabLayout = new QVBoxLayout(metricsTab);
+    metricsTable = new QTableWidget(this);
+    metricsTable->setColumnCount(10);
+    metricsTable->setHorizontalHeaderLabels({"Stream", "Tahap", "Jumlah", "Rata-rata (ms)",
+                                             "p50 (ms)", "p90 (ms)", "p99 (ms)", "Max (ms)",
+                                             "Frame dibuang", "Frame terlambat"});
+    metricsTable->horizontalHeader()->setStretchLastSection(true);
+    metricsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    saveMetricsButton = new QPushButton("Simpan Metrics...", this);
+    connect(saveMetricsButton, &QPushButton::clicked, this, &MainWindow::onSaveMetricsClicked);
+    metricsTabLayout->addWidget(metricsTable);
+    metricsTabLayout->addWidget(saveMetricsButton);
+
     // Add tabs to tab widget
     tabWidget->addTab(videoTab, "Video");
     tabWidget->addTab(streamTab, "Stream Management");
-
-    // Initialize InspireFace with default parameters
-    param.enable_recognition = 1;
-    param.enable_liveness = 1;
-    param.enable_mask_detect = 1;
-    param.enable_face_attribute = 1;
-    param.enable_face_quality = 1;
-    param.enable_ir_liveness = 0;
-    param.enable_interaction_liveness = 0;
-    param.enable_detect_mode_landmark = 1;
+    tabWidget->addTab(metricsTab, "Metrics");
 
     // Disable start button until model is loaded
     startButton->setEnabled(false);
@@ -201,53 +251,26 @@ void MainWindow::loadStreams()
 
     if (doc.isObject()) {
         QJsonObject obj = doc.object();
-        streams = obj["streams"].toArray();
+        streamRegistry.load(obj["streams"].toArray());
+        streamModel->reload();
         QString modelPath = obj["modelPath"].toString();
         if (!modelPath.isEmpty()) {
             modelPathEdit->setText(modelPath);
         }
-        updateStreamComboBox();
-        updateStreamTable();
+        renderFpsCap = obj["renderFpsCap"].toDouble(0);
+        engineConfig = EngineConfig::fromJson(obj);
     }
 }
 
 void MainWindow::saveStreams()
 {
-    QFile file("streams.json");
-    if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Tidak dapat membuka file streams.json untuk ditulis";
-        return;
-    }
-
+    // Written in the background once edits pause; see ConfigWriter
     QJsonObject obj;
-    obj["streams"] = streams;
-    obj["modelPath"] = modelPathEdit->text();
-    QJsonDocument doc(obj);
-    file.write(doc.toJson());
-    file.close();
-}
-
-void MainWindow::updateStreamComboBox()
-{
-    streamComboBox->clear();
-    for (const QJsonValue &value : streams) {
-        QJsonObject obj = value.toObject();
-        streamComboBox->addItem(obj["name"].toString());
-    }
-}
-
-void MainWindow::updateStreamTable()
-{
-    streamTable->blockSignals(true); // Prevent triggering cellChanged while updating
-    streamTable->setRowCount(streams.size());
-    for (int i = 0; i < streams.size(); ++i) {
-        QJsonObject obj = streams[i].toObject();
-        QTableWidgetItem *nameItem = new QTableWidgetItem(obj["name"].toString());
-        QTableWidgetItem *urlItem = new QTableWidgetItem(obj["url"].toString());
-        streamTable->setItem(i, 0, nameItem);
-        streamTable->setItem(i, 1, urlItem);
-    }
-    streamTable->blockSignals(false);
+    obj["streams"] = streamRegistry.toJson();
+    engineConfig.modelPath = modelPathEdit->text();
+    engineConfig.writeJson(obj);
+    obj["renderFpsCap"] = renderFpsCap;
+    configWriter.save(obj);
 }
 
 void MainWindow::onAddStreamClicked()
@@ -260,14 +283,10 @@ void MainWindow::onAddStreamClicked()
         return;
     }
 
-    QJsonObject newStream;
-    newStream["name"] = name;
-    newStream["url"] = url;
-    streams.append(newStream);
-
-    saveStreams();
-    updateStreamComboBox();
-    updateStreamTable();
+    StreamConfig config;
+    config.name = name;
+    config.url = url;
+    streamModel->addStream(config);
 
     streamNameEdit->clear();
     streamUrlEdit->clear();
@@ -275,20 +294,18 @@ void MainWindow::onAddStreamClicked()
 
 void MainWindow::onRemoveStreamClicked()
 {
-    int row = streamTable->currentRow();
-    if (row >= 0 && row < streams.size()) {
-        streams.removeAt(row);
-        saveStreams();
-        updateStreamComboBox();
-        updateStreamTable();
-    }
+    streamModel->removeStream(streamTable->currentIndex().row());
 }
 
 void MainWindow::onStreamSelected(int index)
 {
-    if (index >= 0 && index < streams.size()) {
-        QJsonObject obj = streams[index].toObject();
-        rtspUrlEdit->setText(obj["url"].toString());
+    if (index < 0 || index >= streamRegistry.count()) return;
+    rtspUrlEdit->setText(streamRegistry.config(index).url);
+
+    // While running, the combo box picks which stream is previewed
+    if (isRunning && sourceComboBox->currentIndex() == 1) {
+        engine->setPreviewStream(runningStreamIds.indexOf(streamRegistry.id(index)));
+        videoView->clear();
     }
 }
 
@@ -297,6 +314,13 @@ void MainWindow::onSourceChanged(int index)
     rtspUrlEdit->setEnabled(index == 1); // Enable RTSP URL input only when RTSP is selected
 }
 
+void MainWindow::onViewChanged(int index)
+{
+    // Whichever view is hidden stops receiving frames on the next render tick
+    videoView->setVisible(index == 0);
+    mosaicView->setVisible(index == 1);
+}
+
 void MainWindow::onStartButtonClicked()
 {
     if (!isModelLoaded) {
@@ -307,206 +331,279 @@ void MainWindow::onStartButtonClicked()
     if (isRunning) return;
 
     // Initialize video capture based on selected source
+    QVector<StreamConfig> configs;
+    runningStreamIds.clear();
     if (sourceComboBox->currentIndex() == 0) {
         // Webcam
-        videoCapture = new cv::VideoCapture(0);
-        videoCapture->set(cv::CAP_PROP_FRAME_WIDTH, 1280);
-        videoCapture->set(cv::CAP_PROP_FRAME_HEIGHT, 720);
-        videoCapture->set(cv::CAP_PROP_FPS, 30);
+        StreamConfig webcam;
+        webcam.name = "Webcam";
+        webcam.deviceIndex = 0;
+        configs.append(webcam);
     } else {
-        // RTSP - Get URL from selected stream
-        int selectedIndex = streamComboBox->currentIndex();
-        if (selectedIndex < 0 || selectedIndex >= streams.size()) {
-            QMessageBox::warning(this, "Warning", "Pilih stream terlebih dahulu");
-            return;
-        }
-
-        QJsonObject stream = streams[selectedIndex].toObject();
-        QString url = stream["url"].toString();
-        if (url.isEmpty()) {
-            QMessageBox::warning(this, "Warning", "URL stream tidak valid");
-            return;
-        }
-
-        qDebug() << "Mencoba membuka RTSP stream:" << url;
-
-        // Create VideoCapture with minimal configuration
-        videoCapture = new cv::VideoCapture();
-
-        // Try different connection methods
-        bool success = false;
-        
-        // Method 1: Direct URL with TCP transport
-        QString tcpUrl = url;
-        if (!tcpUrl.contains("transport=")) {
-            tcpUrl += (tcpUrl.contains("?") ? "&" : "?") + QString("transport=tcp");
-        }
-        qDebug() << "Mencoba koneksi dengan URL TCP:" << tcpUrl;
-        success = videoCapture->open(tcpUrl.toStdString());
+        // RTSP - every stream checked in the Stream Management tab runs concurrently
+        for (int row = 0; row < streamRegistry.count(); ++row) {
+            const StreamConfig &config = streamRegistry.config(row);
+            if (!config.enabled || config.url.isEmpty()) continue;
 
-        if (!success) {
-            qDebug() << "Koneksi TCP gagal, mencoba URL langsung";
-            success = videoCapture->open(url.toStdString());
+            configs.append(config);
+            runningStreamIds.append(streamRegistry.id(row));
         }
 
-        if (!success) {
-            qDebug() << "Semua metode koneksi gagal";
-            QMessageBox::critical(this, "Error", 
-                "Tidak dapat membuka stream RTSP: " + url + 
-                "\nPastikan:\n" +
-                "1. URL benar\n" +
-                "2. Server aktif\n" +
-                "3. Kredensial benar\n" +
-                "4. Port tidak diblokir firewall\n" +
-                "5. Coba buka di VLC untuk verifikasi");
-            delete videoCapture;
-            videoCapture = nullptr;
+        if (configs.isEmpty()) {
+            QMessageBox::warning(this, "Warning", "Pilih stream terlebih dahulu");
             return;
         }
+    }
 
-        // Configure stream parameters after successful connection
-        videoCapture->set(cv::CAP_PROP_BUFFERSIZE, 1);
-        videoCapture->set(cv::CAP_PROP_FPS, 30);
+    // More streams enabled since the load than the pool was sized for
+    QString error;
+    models.setWarmUpSizes(ModelManager::warmUpSizes(configs));
+    if (!models.ensureSessions(configs.size(), &error)) {
+        QMessageBox::critical(this, "Error", error);
+        runningStreamIds.clear();
+        return;
     }
 
-    if (!videoCapture->isOpened()) {
-        QMessageBox::critical(this, "Error", "Tidak dapat membuka sumber video");
-        delete videoCapture;
-        videoCapture = nullptr;
+    models.configure(*engine);
+    recorder.setSettings(RecorderSettings::fromJson(engineConfig.recording));
+    sightings.setDirectory(engineConfig.sightingsPath);
+
+    if (!engine->start(configs, models.models(), &error)) {
+        QMessageBox::critical(this, "Error", error);
+        runningStreamIds.clear();
         return;
     }
+    const int selected = streamComboBox->currentIndex();
+    engine->setPreviewStream(sourceComboBox->currentIndex() == 0 ? 0
+                             : selected >= 0 ? runningStreamIds.indexOf(streamRegistry.id(selected)) : -1);
+    QStringList tileNames;
+    for (const StreamConfig &config : configs) {
+        tileNames << (config.name.isEmpty() ? config.url : config.name);
+    }
+    mosaicView->setStreams(tileNames);
 
     isRunning = true;
     startButton->setEnabled(false);
     stopButton->setEnabled(true);
     sourceComboBox->setEnabled(false);
-    streamComboBox->setEnabled(false);
-    timer->start(33); // ~30 FPS
+    streamComboBox->setEnabled(sourceComboBox->currentIndex() == 1);
+    renderTimer->start(renderInterval());
+    metricsTimer->start(1000);
 }
 
-void MainWindow::onStopButtonClicked()
+void MainWindow::onStreamOpenFailed(int index, const QString &url)
 {
+    // With several cameras running, one dead source must not stop the others
+    if (engine->liveStreamCount() > 0) {
+        qDebug() << "Stream" << index << "tidak dapat dibuka:" << url;
+        return;
+    }
+
     stopFaceDetection();
-    if (session) {
-        HFReleaseInspireFaceSession(session);
-        session = nullptr;
+    if (url.isEmpty()) {
+        QMessageBox::critical(this, "Error", "Tidak dapat membuka sumber video");
+        return;
+    }
+
+    QMessageBox::critical(this, "Error",
+        "Tidak dapat membuka stream RTSP: " + url +
+        "\nPastikan:\n" +
+        "1. URL benar\n" +
+        "2. Server aktif\n" +
+        "3. Kredensial benar\n" +
+        "4. Port tidak diblokir firewall\n" +
+        "5. Coba buka di VLC untuk verifikasi");
+}
+
+void MainWindow::onStreamConnectionLost(int index, const QString &message)
+{
+    if (engine->liveStreamCount() > 0) {
+        qDebug() << "Stream" << index << "terputus:" << message;
+        return;
+    }
+
+    stopFaceDetection();
+    QMessageBox::critical(this, "Error", message);
+}
+
+void MainWindow::onStreamEnded(int index)
+{
+    qDebug() << "Stream" << index << "selesai diputar";
+    if (engine->liveStreamCount() == 0) {
+        stopFaceDetection();
     }
-    HFTerminateInspireFace();
+}
+
+void MainWindow::onStreamStateChanged(int index, int state, int attempt, int delayMs)
+{
+    // The single-webcam source has no row in the stream table
+    if (index < 0 || index >= runningStreamIds.size()) return;
+
+    QString status;
+    switch (state) {
+    case CaptureThread::Connecting:
+        status = attempt > 0 ? QString("Menghubungkan (percobaan %1)").arg(attempt + 1) : "Menghubungkan";
+        break;
+    case CaptureThread::Live:
+        status = "Live";
+        break;
+    case CaptureThread::BackingOff:
+        status = QString("Menunggu %1 detik sebelum mencoba lagi").arg(delayMs / 1000.0, 0, 'f', 1);
+        break;
+    case CaptureThread::Failed:
+        status = "Gagal";
+        break;
+    case CaptureThread::Ended:
+        status = "Selesai";
+        break;
+    }
+    streamModel->setStatus(runningStreamIds[index], status);
+}
+
+void MainWindow::onStopButtonClicked()
+{
+    // The models stay loaded so Start can follow right away
+    stopFaceDetection();
 }
 
 void MainWindow::stopFaceDetection()
 {
     if (!isRunning) return;
 
-    timer->stop();
-    if (videoCapture) {
-        videoCapture->release();
-        delete videoCapture;
-        videoCapture = nullptr;
+    renderTimer->stop();
+    updateMetrics();
+    metricsTimer->stop();
+    logStartupMetrics(engine->metricsSnapshot());
+    engine->stop();
+    streamModel->clearStatuses();
+    runningStreamIds.clear();
+    qDebug() << "Ekstraksi fitur:" << engine->featureExtractions()
+             << "dijalankan," << engine->reusedEmbeddings() << "memakai cache track";
+    qDebug() << "Deteksi dilewati karena scene statis:" << engine->motionSkippedFrames();
+    if (recorder.enabled()) {
+        qDebug() << "Rekaman:" << recorder.clipsWritten() << "klip ditulis,"
+                 << recorder.shedFrames() << "frame dilewati karena encoder atau disk tertinggal";
+    }
+    if (sightings.enabled()) {
+        qDebug() << "Sightings ditulis:" << sightings.sightingsWritten();
     }
 
     isRunning = false;
-    startButton->setEnabled(true);
+    startButton->setEnabled(isModelLoaded && !isModelLoading);
     stopButton->setEnabled(false);
     sourceComboBox->setEnabled(true);
     streamComboBox->setEnabled(true);
     rtspUrlEdit->setEnabled(sourceComboBox->currentIndex() == 1);
-    videoLabel->clear();
+    videoView->clear();
+    mosaicView->clear();
 }
 
-void MainWindow::updateFrame()
+int MainWindow::renderInterval() const
 {
-    if (!videoCapture || !videoCapture->isOpened()) {
-        stopFaceDetection();
-        QMessageBox::critical(this, "Error", "Koneksi video terputus");
-        return;
-    }
+    // Render at the monitor's rate, optionally capped; detection runs at its own pace
+    QScreen *screen = QGuiApplication::primaryScreen();
+    double fps = screen ? screen->refreshRate() : 60.0;
+    if (fps <= 0) fps = 60.0;
+    if (renderFpsCap > 0) fps = std::min(fps, renderFpsCap);
+    return std::max(1, qRound(1000.0 / fps));
+}
 
-    cv::Mat frame;
-    if (!videoCapture->read(frame)) {
-        if (sourceComboBox->currentIndex() == 1) { // RTSP
-            // Try to reconnect
-            int selectedIndex = streamComboBox->currentIndex();
-            if (selectedIndex >= 0 && selectedIndex < streams.size()) {
-                QJsonObject stream = streams[selectedIndex].toObject();
-                QString url = stream["url"].toString();
-                QString rtspURL = "rtsp_transport=tcp&" + url;
-                if (!videoCapture->open(rtspURL.toStdString(), cv::CAP_FFMPEG)) {
-                    stopFaceDetection();
-                    QMessageBox::critical(this, "Error", "Gagal membaca frame dan reconnect ke RTSP stream");
-                    return;
-                }
-                videoCapture->set(cv::CAP_PROP_BUFFERSIZE, 1);
-                videoCapture->set(cv::CAP_PROP_FPS, 30);
-            }
-        } else {
-            stopFaceDetection();
-            QMessageBox::critical(this, "Error", "Gagal membaca frame dari kamera");
-            return;
-        }
-        return;
+void MainWindow::renderFrame()
+{
+    // The mosaic switches off or throttles the streams of its hidden and small tiles itself
+    const int64_t mosaicStarted = LatencyHistogram::nowNs();
+    if (mosaicView->refresh(engine) > 0) {
+        displayLatency.record(LatencyHistogram::nowNs() - mosaicStarted);
     }
 
+    // Nobody can see the preview: tell the workers to skip overlays and skip all conversion here
+    const bool visible = videoView->isVisible() && !isMinimized();
+    engine->setPreviewPaused(!visible);
+    if (!visible) return;
+
+    // Only the newest finished frame is converted; ticks without a new frame cost nothing
+    FramePtr processed = engine->takePreviewFrame();
+    if (!processed) return;
+
+    cv::Mat &frame = processed->image;
     if (frame.empty()) return;
+    const int64_t started = LatencyHistogram::nowNs();
+
+    // Downscale and convert to RGB in one pass, straight into the image the view paints
+    QImage *image = videoView->frameImage(QSize(frame.cols, frame.rows));
+    if (!image) return;
+    previewScaler.scale(frame, image->bits(), image->width(), image->height(), int(image->bytesPerLine()));
+    overlayPainter.paint(*image, processed->faces, double(image->width()) / frame.cols);
+    videoView->present();
+    displayLatency.record(LatencyHistogram::nowNs() - started);
+}
 
-    // Convert frame to InspireFace format
-    HFImageData imageData;
-    imageData.data = frame.data;
-    imageData.width = frame.cols;
-    imageData.height = frame.rows;
-    imageData.format = HF_STREAM_BGR;
-    imageData.rotation = HF_CAMERA_ROTATION_0;
-
-    HFImageStream streamHandle;
-    HResult ret = HFCreateImageStream(&imageData, &streamHandle);
-    if (ret != HSUCCEED) {
-        qDebug() << "Error: Gagal membuat image stream";
-        return;
-    }
+std::vector<PipelineMetricsSnapshot> MainWindow::collectMetrics() const
+{
+    std::vector<PipelineMetricsSnapshot> metrics = engine->metricsSnapshot();
+
+    // Display runs on the GUI thread for whichever stream is previewed
+    PipelineMetricsSnapshot preview;
+    preview.stream = "Preview";
+    preview.stages[StageDisplay] = displayLatency.snapshot();
+    metrics.push_back(preview);
+    return metrics;
+}
 
-    // Detect faces
-    HFMultipleFaceData results;
-    ret = HFExecuteFaceTrack(session, streamHandle, &results);
-    if (ret == HSUCCEED) {
-        for (int i = 0; i < results.detectedNum; i++) {
-            // Draw rectangle around face
-            cv::Rect faceRect(
-                results.rects[i].x,
-                results.rects[i].y,
-                results.rects[i].width,
-                results.rects[i].height
-            );
-            cv::rectangle(frame, faceRect, cv::Scalar(0, 255, 0), 2);
-
-            // Display confidence
-            std::string confidence = "Conf: " + std::to_string(results.detConfidence[i]);
-            cv::putText(frame, confidence, cv::Point(faceRect.x, faceRect.y - 30),
-                      cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
-
-            // Display tracking ID
-            std::string text = "ID: " + std::to_string(results.trackIds[i]);
-            cv::putText(frame, text, cv::Point(faceRect.x, faceRect.y - 10),
-                      cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
-
-            // Display face angles if available
-            if (results.angles.yaw && results.angles.pitch && results.angles.roll) {
-                std::string angles = "Yaw: " + std::to_string(int(*results.angles.yaw)) +
-                                  " Pitch: " + std::to_string(int(*results.angles.pitch)) +
-                                  " Roll: " + std::to_string(int(*results.angles.roll));
-                cv::putText(frame, angles, cv::Point(faceRect.x, faceRect.y + faceRect.height + 20),
-                          cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 2);
+void MainWindow::updateMetrics()
+{
+    // Only refresh what somebody is looking at
+    if (!metricsTable->isVisible()) return;
+
+    const std::vector<PipelineMetricsSnapshot> metrics = collectMetrics();
+    int row = 0;
+    for (const PipelineMetricsSnapshot &stream : metrics) {
+        bool firstRow = true;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            const LatencyHistogram::Snapshot &histogram = stream.stages[stage];
+            if (histogram.count == 0) continue;
+
+            if (row >= metricsTable->rowCount()) metricsTable->insertRow(row);
+            // Frame counters belong to the stream, not a stage; show them once
+            const bool isPreview = stage == StageDisplay;
+            const QString dropped = firstRow && !isPreview ? QString::number(qulonglong(stream.droppedFrames)) : QString();
+            const QString late = firstRow && !isPreview ? QString::number(qulonglong(stream.lateFrames)) : QString();
+            firstRow = false;
+            const QStringList cells = {
+                stream.stream,
+                pipelineStageName(stage),
+                QString::number(qulonglong(histogram.count)),
+                QString::number(histogram.meanMs(), 'f', 2),
+                QString::number(histogram.percentileMs(0.50), 'f', 2),
+                QString::number(histogram.percentileMs(0.90), 'f', 2),
+                QString::number(histogram.percentileMs(0.99), 'f', 2),
+                QString::number(histogram.maxMs(), 'f', 2),
+                dropped,
+                late,
+            };
+            for (int column = 0; column < cells.size(); ++column) {
+                QTableWidgetItem *item = metricsTable->item(row, column);
+                if (!item) {
+                    item = new QTableWidgetItem;
+                    metricsTable->setItem(row, column, item);
+                }
+                item->setText(cells[column]);
             }
+            ++row;
         }
     }
+    metricsTable->setRowCount(row);
+}
 
-    // Release image stream
-    HFReleaseImageStream(streamHandle);
+void MainWindow::onSaveMetricsClicked()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Simpan Metrics", "metrics.json", "JSON (*.json)");
+    if (path.isEmpty()) return;
 
-    // Convert frame to QImage and display
-    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
-    QImage qImage(frame.data, frame.cols, frame.rows, frame.step, QImage::Format_RGB888);
-    videoLabel->setPixmap(QPixmap::fromImage(qImage).scaled(
-        videoLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    QString error;
+    if (!writeMetricsJson(path, collectMetrics(), &error)) {
+        QMessageBox::warning(this, "Warning", error);
+    }
 }
 
 void MainWindow::scanModelDirectory()
@@ -553,7 +650,7 @@ void MainWindow::onModelPathButtonClicked()
 
 void MainWindow::onModelSelectionChanged()
 {
-    loadModelButton->setEnabled(modelListWidget->selectedItems().count() > 0);
+    updateModelControls();
 }
 
 bool MainWindow::initializeInspireFace()
@@ -564,54 +661,72 @@ bool MainWindow::initializeInspireFace()
         return false;
     }
 
-    QString modelPath = modelPathEdit->text();
-    QString modelName = selectedItems.first()->text();
-    QString modelFullPath = modelPath + "/" + modelName;
+    engineConfig.modelPath = modelPathEdit->text();
+    engineConfig.modelName = selectedItems.first()->text();
 
-    // Initialize InspireFace with model path
-    HResult ret = HFLaunchInspireFace(modelFullPath.toStdString().c_str());
-    if (ret != HSUCCEED) {
-        QMessageBox::critical(this, "Error", QString("Gagal menginisialisasi InspireFace. Error code: %1").arg(ret));
-        return false;
+    // One light-tracking session per enabled stream (at least one per core) so
+    // detection on different cameras never shares a session. Streams enabled
+    // later get theirs at Start; a registry of thousands must not mean
+    // thousands of sessions.
+    QVector<StreamConfig> configs;
+    for (int row = 0; row < streamRegistry.count(); ++row) {
+        if (streamRegistry.config(row).enabled) configs.append(streamRegistry.config(row));
     }
+    const int poolSize = std::max(QThread::idealThreadCount(), int(configs.size()));
 
-    // Set custom parameters
-    param.enable_recognition = 1;
-    param.enable_liveness = 1;
-    param.enable_mask_detect = 1;
-    param.enable_face_attribute = 1;
-    param.enable_face_quality = 1;
-    param.enable_ir_liveness = 0;
-    param.enable_interaction_liveness = 0;
-    param.enable_detect_mode_landmark = 1;
-
-    // Create session with light tracking mode
-    ret = HFCreateInspireFaceSession(param, HF_DETECT_MODE_LIGHT_TRACK, 1, 320, 0, &session);
-    if (ret != HSUCCEED) {
-        QMessageBox::critical(this, "Error", QString("Gagal membuat session. Error code: %1").arg(ret));
-        HFTerminateInspireFace();
-        return false;
-    }
+    // Launch, session creation and warm-up run off the GUI thread; onModelLoaded() picks up the result
+    isModelLoading = true;
+    modelProgress->setValue(0);
+    modelProgress->show();
+    updateModelControls();
+    modelLoader->load(engineConfig.modelFile(), engineConfig, poolSize, ModelManager::warmUpSizes(configs));
+    return true;
+}
+
+void MainWindow::onModelLoadProgress(int percent, const QString &step)
+{
+    modelProgress->setValue(percent);
+    modelProgress->setFormat(step + " (%p%)");
+}
 
-    // Set detection parameters
-    HFSessionSetFaceDetectThreshold(session, 0.7f);
-    HFSessionSetTrackModeSmoothRatio(session, 0.7f);
-    HFSessionSetFilterMinimumFacePixelSize(session, 60);
+void MainWindow::onModelLoaded()
+{
+    isModelLoading = false;
+    modelProgress->hide();
+    if (!modelLoader->succeeded()) {
+        // A failed swap reloads the previous pack; if even that failed, the running sessions are unusable
+        if (models.isLoaded()) {
+            engineConfig.modelName = QFileInfo(models.modelFile()).fileName();
+        } else {
+            unloadModel();
+        }
+        updateModelControls();
+        QMessageBox::critical(this, "Error", modelLoader->errorMessage());
+        return;
+    }
+    if (!modelLoader->warningMessage().isEmpty()) {
+        QMessageBox::warning(this, "Warning", modelLoader->warningMessage());
+    }
+    qDebug() << "Model siap dalam" << qRound(models.loadMs()) << "ms, termasuk pemanasan"
+             << qRound(models.warmUpMs()) << "ms";
+    if (isRunning) {
+        // Thresholds and stage demand come with the pack's config, like at Start
+        models.configure(*engine);
+        engine->setModels(models.models());
+        qDebug() << "Stream beralih ke model" << engineConfig.modelName;
+    }
 
     isModelLoaded = true;
     updateModelControls();
     saveStreams();
-    return true;
 }
 
 void MainWindow::unloadModel()
 {
     if (isModelLoaded) {
-        if (session) {
-            HFReleaseInspireFaceSession(session);
-            session = nullptr;
-        }
-        HFTerminateInspireFace();
+        // Workers must hand their sessions back before the pool is released
+        stopFaceDetection();
+        models.unload();
         isModelLoaded = false;
         updateModelControls();
     }
@@ -619,36 +734,29 @@ void MainWindow::unloadModel()
 
 void MainWindow::updateModelControls()
 {
-    modelPathEdit->setEnabled(!isModelLoaded);
-    modelPathButton->setEnabled(!isModelLoaded);
-    modelListWidget->setEnabled(!isModelLoaded);
-    loadModelButton->setText(isModelLoaded ? "Unload Model" : "Load Selected Model");
-    startButton->setEnabled(isModelLoaded);
+    const bool idle = !isModelLoaded && !isModelLoading;
+    modelPathEdit->setEnabled(idle);
+    modelPathButton->setEnabled(idle);
+    modelListWidget->setEnabled(!isModelLoading);
+    const bool selected = !modelListWidget->selectedItems().isEmpty();
+    loadModelButton->setEnabled(!isModelLoading && (isModelLoaded || selected));
+    loadModelButton->setText(isModelLoading ? "Memuat Model..." : isModelLoaded ? "Unload Model" : "Load Selected Model");
+    swapModelButton->setEnabled(isModelLoaded && !isModelLoading && selected);
+    startButton->setEnabled(isModelLoaded && !isModelLoading && !isRunning);
 }
 
 void MainWindow::onLoadModelClicked()
 {
     if (isModelLoaded) {
         unloadModel();
-    } else {
+    } else if (!isModelLoading) {
         initializeInspireFace();
     }
 }
 
-void MainWindow::onStreamTableChanged(int row, int column)
+void MainWindow::onSwapModelClicked()
 {
-    if (row < 0 || row >= streams.size()) return;
-
-    QJsonObject stream = streams[row].toObject();
-    QString newValue = streamTable->item(row, column)->text();
-
-    if (column == 0) { // Name column
-        stream["name"] = newValue;
-    } else if (column == 1) { // URL column
-        stream["url"] = newValue;
+    if (isModelLoaded && !isModelLoading) {
+        initializeInspireFace();
     }
-
-    streams[row] = stream;
-    saveStreams();
-    updateStreamComboBox();
-} 
\ No newline at end of file
+}
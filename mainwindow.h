@@ -9,19 +9,33 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QTableView>
 #include <QTableWidget>
 #include <QHeaderView>
 #include <QJsonArray>
+#include <QJsonObject>
 #include <QCheckBox>
 #include <QListWidget>
 #include <QTabWidget>
+#include <QImage>
+#include <QProgressBar>
 #include <opencv2/opencv.hpp>
 #include <inspireface.h>
+#include "configwriter.h"
+#include "engineconfig.h"
+#include "eventrecorder.h"
+#include "modelloader.h"
+#include "modelmanager.h"
+#include "mosaicview.h"
+#include "overlaypainter.h"
+#include "previewscaler.h"
+#include "sightingslog.h"
+#include "streamengine.h"
+#include "streamregistry.h"
+#include "streamtablemodel.h"
+#include "videoview.h"
 
 class QTimer;
-namespace cv {
-    class VideoCapture;
-}
 
 class MainWindow : public QMainWindow
 {
@@ -35,26 +49,35 @@ private slots:
     void onStartButtonClicked();
     void onStopButtonClicked();
     void onSourceChanged(int index);
+    void onViewChanged(int index);
     void onStreamSelected(int index);
     void onAddStreamClicked();
     void onRemoveStreamClicked();
     void onModelPathButtonClicked();
     void onLoadModelClicked();
+    void onSwapModelClicked();
     void onModelSelectionChanged();
-    void onStreamTableChanged(int row, int column);
+    void onModelLoadProgress(int percent, const QString &step);
+    void onModelLoaded();
+    void onStreamOpenFailed(int index, const QString &url);
+    void onStreamConnectionLost(int index, const QString &message);
+    void onStreamEnded(int index);
+    void onStreamStateChanged(int index, int state, int attempt, int delayMs);
+    void onSaveMetricsClicked();
 
 private:
     void setupUI();
     void loadStreams();
     void saveStreams();
-    void updateStreamComboBox();
-    void updateStreamTable();
     void scanModelDirectory();
     bool initializeInspireFace();
     void unloadModel();
     void updateModelControls();
     void stopFaceDetection();
-    void updateFrame();
+    void renderFrame();
+    void updateMetrics();
+    std::vector<PipelineMetricsSnapshot> collectMetrics() const;
+    int renderInterval() const;
 
     QTabWidget *tabWidget;
     QGroupBox *modelGroup;
@@ -65,10 +88,13 @@ private:
     QLineEdit *modelPathEdit;
     QPushButton *modelPathButton;
     QPushButton *loadModelButton;
+    QPushButton *swapModelButton;
     QListWidget *modelListWidget;
+    QProgressBar *modelProgress;
 
     QComboBox *sourceComboBox;
     QComboBox *streamComboBox;
+    QComboBox *viewComboBox;
     QLineEdit *rtspUrlEdit;
     QLineEdit *streamNameEdit;
     QLineEdit *streamUrlEdit;
@@ -77,17 +103,32 @@ private:
     QPushButton *addStreamButton;
     QPushButton *removeStreamButton;
 
-    QLabel *videoLabel;
-    QTableWidget *streamTable;
+    VideoView *videoView;
+    MosaicView *mosaicView;
+    QTableView *streamTable;
+    QTableWidget *metricsTable;
+    QPushButton *saveMetricsButton;
 
-    cv::VideoCapture *videoCapture;
-    QTimer *timer;
+    StreamEngine *engine;
+    QVector<int> runningStreamIds; // engine stream index -> StreamRegistry ID
+    QTimer *renderTimer;
+    double renderFpsCap; // 0 = follow the monitor refresh rate
+    PreviewScaler previewScaler;
+    OverlayPainter overlayPainter;
+    QTimer *metricsTimer;
+    LatencyHistogram displayLatency; // Written by the GUI thread only
     bool isRunning;
     bool isModelLoaded;
-    QJsonArray streams;
+    bool isModelLoading;
+    StreamRegistry streamRegistry;
+    StreamTableModel *streamModel;
+    ConfigWriter configWriter; // streams.json
 
-    HFSession session;
-    HFSessionCustomParameter param;
+    EngineConfig engineConfig;
+    ModelManager models;
+    ModelLoader *modelLoader; // Owns models while isModelLoading
+    EventRecorder recorder;
+    SightingsLog sightings;
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "modelloader.h"
+#include "modelmanager.h"
+
+ModelLoader::ModelLoader(ModelManager *models, QObject *parent)
+    : QThread(parent)
+    , models(models)
+    , poolSize(1)
+    , ok(false)
+{
+}
+
+ModelLoader::~ModelLoader()
+{
+    wait();
+}
+
+void ModelLoader::load(const QString &file, const EngineConfig &engineConfig, int sessions,
+                       const std::vector<cv::Size> &warmUpSizes)
+{
+    if (isRunning()) return;
+
+    modelFile = file;
+    config = engineConfig;
+    poolSize = sessions;
+    ok = false;
+    error.clear();
+    warning.clear();
+    models->setWarmUpSizes(warmUpSizes);
+    models->setProgressCallback([this](int percent, const QString &step) { emit progress(percent, step); });
+    start();
+}
+
+void ModelLoader::run()
+{
+    ok = models->load(modelFile, config, poolSize, &error, &warning);
+}
@@ -0,0 +1,48 @@
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include <QString>
+#include <QThread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "engineconfig.h"
+
+class ModelManager;
+
+// Runs ModelManager::load() on its own thread so the window stays
+// responsive while InspireFace launches, sessions are created and warmed up.
+// progress() is emitted from the loading thread; connect it normally and Qt
+// queues it to the receiver. The outcome is valid once finished() arrives.
+class ModelLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ModelLoader(ModelManager *models, QObject *parent = nullptr);
+    ~ModelLoader();
+
+    // models must not be used by anyone else until finished()
+    void load(const QString &modelFile, const EngineConfig &config, int poolSize,
+              const std::vector<cv::Size> &warmUpSizes);
+
+    bool succeeded() const { return ok; }
+    QString errorMessage() const { return error; }
+    QString warningMessage() const { return warning; }
+
+signals:
+    void progress(int percent, const QString &step);
+
+protected:
+    void run() override;
+
+private:
+    ModelManager *models;
+    QString modelFile;
+    EngineConfig config;
+    int poolSize;
+    bool ok;
+    QString error;
+    QString warning;
+};
+
+#endif // MODELLOADER_H
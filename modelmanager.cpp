@@ -0,0 +1,251 @@
+#include "modelmanager.h"
+#include "galleryenrollment.h"
+#include "latencyhistogram.h"
+#include "streamengine.h"
+#include <QDebug>
+#include <QWriteLocker>
+#include <algorithm>
+
+namespace {
+
+// Detection input assumed for streams at native resolution, whose size is unknown until they open
+const cv::Size kNativeWarmUpSize(1280, 720);
+// The first pass at a size allocates; the second one shows it is done
+const int kWarmUpPasses = 2;
+
+// Nesting depth of InspireFaceCall on this thread; plain int, so operator new can read it at any time
+thread_local int inspireFaceCalls = 0;
+
+// Load only the optional models that faceStages asks for; they run lazily per track
+SessionSettings sessionSettings(const EngineConfig &config)
+{
+    SessionSettings settings;
+    settings.param = sessionParameter(config.stagesForAll | config.stagesForMatched);
+    settings.detectPixelLevel = config.detectPixelLevel;
+    settings.maxDetectFaces = config.maxDetectFaces;
+    return settings;
+}
+
+} // namespace
+
+QReadWriteLock &inspireFaceLock()
+{
+    static QReadWriteLock lock;
+    return lock;
+}
+
+InspireFaceCall::InspireFaceCall()
+{
+    ++inspireFaceCalls;
+}
+
+InspireFaceCall::~InspireFaceCall()
+{
+    --inspireFaceCalls;
+}
+
+bool InspireFaceCall::active()
+{
+    return inspireFaceCalls > 0;
+}
+
+ModelManager::ModelManager()
+    : totalMs(0)
+    , warmMs(0)
+    , launched(false)
+{
+}
+
+ModelManager::~ModelManager()
+{
+    unload();
+}
+
+bool ModelManager::load(const QString &modelFile, const EngineConfig &engineConfig, int poolSize,
+                        QString *errorMessage, QString *warningMessage)
+{
+    const int64_t started = LatencyHistogram::nowNs();
+
+    // The pack is process-wide, so running streams wait out the reload itself.
+    // Their sessions were built from the previous pack and keep running on it
+    // until they switch; that relies on sessions owning the networks they
+    // loaded, which the SDK does not document. Sessions can only be created
+    // from the loaded pack, so the new set cannot be built before the reload;
+    // a failure after it reloads the previous pack instead.
+    report(0, "Memuat model");
+    const std::string path = modelFile.toStdString();
+    HResult ret;
+    {
+        QWriteLocker locker(&inspireFaceLock());
+        ret = launched ? HFReloadInspireFace(path.c_str()) : HFLaunchInspireFace(path.c_str());
+    }
+    if (ret != HSUCCEED) {
+        if (errorMessage) {
+            *errorMessage = QString("Gagal menginisialisasi InspireFace. Error code: %1").arg(ret);
+        }
+        if (current) restorePrevious(errorMessage);
+        return false;
+    }
+    launched = true;
+
+    ModelSetPtr set = std::make_shared<ModelSet>();
+    set->modelFile = modelFile;
+    const SessionSettings settings = sessionSettings(engineConfig);
+    report(20, QString("Membuat %1 session").arg(poolSize));
+    std::vector<HFSession> sessions;
+    if (!set->pool.grow(poolSize, settings, &ret, &sessions)) {
+        if (errorMessage) {
+            *errorMessage = QString("Gagal membuat session. Error code: %1").arg(ret);
+        }
+        if (current) {
+            restorePrevious(errorMessage);
+        } else {
+            QWriteLocker locker(&inspireFaceLock());
+            HFTerminateInspireFace();
+            launched = false;
+        }
+        return false;
+    }
+
+    // Enroll the gallery so tracked faces can be identified
+    HInt32 featureLength = 0;
+    HFGetFeatureLength(&featureLength);
+    set->gallery.reset(featureLength);
+    set->gallery.setIndex(createGalleryIndex(engineConfig.galleryIndex));
+    if (!engineConfig.galleryPath.isEmpty()) {
+        report(50, "Mendaftarkan galeri");
+        QString error;
+        int enrolled = enrollGalleryDirectory(set->gallery, engineConfig.galleryPath, settings, &error);
+        if (enrolled < 0) {
+            if (warningMessage) *warningMessage = error;
+        } else {
+            qDebug() << "Galeri:" << enrolled << "wajah terdaftar, indeks" << set->gallery.indexName()
+                     << "kernel" << FaceGallery::kernelName();
+        }
+    }
+
+    const double warmUpMs = warmUp(sessions);
+    totalMs = (LatencyHistogram::nowNs() - started) / 1e6;
+    report(100, "Model siap");
+
+    // Streams still on the previous set keep it alive until they switch
+    warmMs = warmUpMs;
+    config = engineConfig;
+    current = set;
+    return true;
+}
+
+std::vector<cv::Size> ModelManager::warmUpSizes(const QVector<StreamConfig> &streams)
+{
+    std::vector<cv::Size> sizes;
+    for (const StreamConfig &stream : streams) {
+        if (!stream.enabled) continue;
+        const cv::Size size = stream.detectWidth > 0
+                              ? cv::Size(stream.detectWidth, stream.detectWidth * 9 / 16) : kNativeWarmUpSize;
+        if (std::find(sizes.begin(), sizes.end(), size) == sizes.end()) sizes.push_back(size);
+    }
+    if (sizes.empty()) sizes.push_back(kNativeWarmUpSize);
+    return sizes;
+}
+
+void ModelManager::restorePrevious(QString *errorMessage)
+{
+    const std::string path = current->modelFile.toStdString();
+    HResult ret;
+    {
+        QWriteLocker locker(&inspireFaceLock());
+        ret = HFReloadInspireFace(path.c_str());
+    }
+    if (ret == HSUCCEED) return;
+
+    // The running sessions now sit on a pack that is gone; nothing may use them any more
+    qDebug() << "Error: Gagal memuat ulang model sebelumnya" << current->modelFile << "Error code:" << ret;
+    if (errorMessage) {
+        *errorMessage += QString("\nModel sebelumnya juga gagal dimuat ulang (error code: %1); "
+                                 "stream harus dihentikan").arg(ret);
+    }
+    current.reset();
+}
+
+void ModelManager::report(int percent, const QString &step) const
+{
+    if (progress) progress(percent, step);
+}
+
+bool ModelManager::ensureSessions(int count, QString *errorMessage)
+{
+    if (!current || current->pool.size() >= count) return true;
+
+    const int64_t started = LatencyHistogram::nowNs();
+    std::vector<HFSession> added;
+    HResult ret = HSUCCEED;
+    if (!current->pool.grow(count, sessionSettings(config), &ret, &added)) {
+        if (errorMessage) {
+            *errorMessage = QString("Gagal menambah session menjadi %1. Error code: %2").arg(count).arg(ret);
+        }
+        return false;
+    }
+    warmUp(added);
+    qDebug() << "Session ditambah:" << added.size() << "dalam" << qRound((LatencyHistogram::nowNs() - started) / 1e6)
+             << "ms";
+    return true;
+}
+
+double ModelManager::warmUp(const std::vector<HFSession> &sessions)
+{
+    // Sessions set up their inference buffers on the first frames they see;
+    // pay for that here rather than as a latency spike right after Start
+    if (warmUpFrameSizes.empty()) return 0.0;
+    const int64_t started = LatencyHistogram::nowNs();
+
+    // Noise keeps the detector from taking any shortcut on a flat image
+    cv::Mat frame;
+    cv::RNG rng(0x5eed);
+    const std::vector<cv::Size> &sizes = warmUpFrameSizes;
+    const int steps = int(sessions.size() * sizes.size());
+    int step = 0;
+    for (const cv::Size &size : sizes) {
+        frame.create(size, CV_8UC3);
+        rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+
+        HFImageData imageData;
+        imageData.data = frame.data;
+        imageData.width = frame.cols;
+        imageData.height = frame.rows;
+        imageData.format = HF_STREAM_BGR;
+        imageData.rotation = HF_CAMERA_ROTATION_0;
+        for (HFSession session : sessions) {
+            report(70 + 30 * step++ / std::max(1, steps),
+                   QString("Pemanasan session %1x%2").arg(size.width).arg(size.height));
+            for (int pass = 0; pass < kWarmUpPasses; ++pass) {
+                HFImageStream streamHandle;
+                if (HFCreateImageStream(&imageData, &streamHandle) != HSUCCEED) break;
+                HFMultipleFaceData results;
+                HFExecuteFaceTrack(session, streamHandle, &results);
+                HFReleaseImageStream(streamHandle);
+            }
+        }
+    }
+
+    return (LatencyHistogram::nowNs() - started) / 1e6;
+}
+
+void ModelManager::unload()
+{
+    if (current && current.use_count() > 1) {
+        qDebug() << "Peringatan: model masih dipakai saat dilepas";
+    }
+    current.reset();
+    if (launched) {
+        QWriteLocker locker(&inspireFaceLock());
+        HFTerminateInspireFace();
+        launched = false;
+    }
+}
+
+void ModelManager::configure(StreamEngine &engine) const
+{
+    engine.setMatchThreshold(float(config.matchThreshold));
+    engine.setEmbeddingCachePolicy(config.embeddingRefreshMs, float(config.embeddingQualityGain));
+    engine.setStageDemand(config.stagesForAll, config.stagesForMatched);
+}
@@ -0,0 +1,84 @@
+#ifndef MODELMANAGER_H
+#define MODELMANAGER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "engineconfig.h"
+#include "modelset.h"
+#include "streamconfig.h"
+
+class StreamEngine;
+
+// Owns everything that lives between HFLaunchInspireFace and
+// HFTerminateInspireFace. Each load() builds a complete ModelSet (sessions
+// and enrolled gallery) before it becomes current, so loading a new pack
+// while streams run only costs them the switch: StreamEngine::setModels()
+// moves each stream over at its next frame and the old sessions are released
+// once the last stream has left them. Used by both the GUI and the headless
+// daemon, so it reports errors as strings and never touches widgets.
+class ModelManager
+{
+public:
+    // Called from whichever thread runs load(); percent goes from 0 to 100
+    typedef std::function<void(int percent, const QString &step)> ProgressCallback;
+
+    ModelManager();
+    ~ModelManager();
+
+    ModelManager(const ModelManager &) = delete;
+    ModelManager &operator=(const ModelManager &) = delete;
+
+    // Set before load()
+    void setProgressCallback(ProgressCallback callback) { progress = std::move(callback); }
+    // Frame sizes every session is warmed up with before load() returns; none skips the warm-up
+    void setWarmUpSizes(const std::vector<cv::Size> &sizes) { warmUpFrameSizes = sizes; }
+    // The detection input size of each stream, deduplicated
+    static std::vector<cv::Size> warmUpSizes(const QVector<StreamConfig> &streams);
+
+    // Launches InspireFace with modelFile (or reloads it when a pack is
+    // already loaded), creates poolSize sessions, enrolls config.galleryPath
+    // and warms every session up. Only then does the new set become current;
+    // on failure the previous pack is reloaded and its set stays. Should that
+    // reload fail too, isLoaded() turns false and any engine still running on
+    // the old set must be stopped. Gallery problems do not fail the load; they
+    // are reported through warningMessage. Safe to run on a worker thread as
+    // long as nothing else touches this object.
+    bool load(const QString &modelFile, const EngineConfig &config, int poolSize,
+              QString *errorMessage = nullptr, QString *warningMessage = nullptr);
+    // Any engine using the sessions must be stopped first
+    void unload();
+
+    bool isLoaded() const { return bool(current); }
+    const ModelSetPtr &models() const { return current; }
+    QString modelFile() const { return current ? current->modelFile : QString(); }
+    // Time the last load() spent in total and on the warm-up alone
+    double loadMs() const { return totalMs; }
+    double warmUpMs() const { return warmMs; }
+
+    // Grows the current pool to count sessions, warmed up like the rest, so
+    // more streams can start than the load was sized for. Engine stopped only.
+    bool ensureSessions(int count, QString *errorMessage = nullptr);
+
+    // Hands the recognition settings of the last load to engine
+    void configure(StreamEngine &engine) const;
+
+private:
+    void report(int percent, const QString &step) const;
+    // Reloads the pack of current after a failed swap; drops current if that fails too
+    void restorePrevious(QString *errorMessage);
+    // Returns the milliseconds it took
+    double warmUp(const std::vector<HFSession> &sessions);
+
+    EngineConfig config;
+    ProgressCallback progress;
+    std::vector<cv::Size> warmUpFrameSizes;
+    double totalMs;
+    double warmMs;
+    ModelSetPtr current;
+    bool launched; // HFLaunchInspireFace succeeded and has not been terminated
+};
+
+#endif // MODELMANAGER_H
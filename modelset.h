@@ -0,0 +1,44 @@
+#ifndef MODELSET_H
+#define MODELSET_H
+
+#include <QReadWriteLock>
+#include <QString>
+#include <memory>
+#include "facegallery.h"
+#include "sessionpool.h"
+
+// Everything that belongs to one model pack: its sessions and the gallery
+// enrolled with them. Features from different packs cannot be compared, so a
+// stream always searches the gallery of the set its session came from.
+// Shared by the ModelManager and every stream using it; when the last
+// reference goes, the sessions are released.
+struct ModelSet
+{
+    QString modelFile;
+    SessionPool pool;
+    FaceGallery gallery;
+};
+
+typedef std::shared_ptr<ModelSet> ModelSetPtr;
+
+// The loaded pack is process-wide. Every frame holds this for reading while
+// it is inside the SDK; ModelManager holds it for writing around
+// HFLaunchInspireFace, HFReloadInspireFace and HFTerminateInspireFace, so
+// the pack is never replaced under a running inference call.
+QReadWriteLock &inspireFaceLock();
+
+// Marks the calling thread as inside an SDK call for as long as it lives, so
+// allocation counters can leave out what the SDK allocates internally
+class InspireFaceCall
+{
+public:
+    InspireFaceCall();
+    ~InspireFaceCall();
+
+    InspireFaceCall(const InspireFaceCall &) = delete;
+    InspireFaceCall &operator=(const InspireFaceCall &) = delete;
+
+    static bool active();
+};
+
+#endif // MODELSET_H
@@ -0,0 +1,133 @@
+#include "mosaicview.h"
+#include "streamengine.h"
+#include <QPaintEvent>
+#include <QPainter>
+#include <cmath>
+
+namespace {
+
+const int kTileGap = 2;
+// Tiles narrower than this are too small to follow motion in; they refresh at kSmallTileFps
+const int kSmallTileWidth = 320;
+const double kSmallTileFps = 5.0;
+
+} // namespace
+
+MosaicView::MosaicView(QWidget *parent)
+    : QWidget(parent)
+{
+    // Every pixel comes from the canvas, so Qt need not clear the background first
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(640, 480);
+}
+
+void MosaicView::setStreams(const QStringList &names)
+{
+    tiles.clear();
+    tiles.resize(names.size());
+    for (int i = 0; i < names.size(); ++i) {
+        tiles[i].name = names[i];
+    }
+    layoutTiles();
+}
+
+void MosaicView::clear()
+{
+    setStreams(QStringList());
+}
+
+void MosaicView::layoutTiles()
+{
+    canvas = QImage(size(), QImage::Format_RGB888);
+    canvas.fill(Qt::black);
+
+    if (!tiles.empty()) {
+        // Smallest near-square grid that fits every stream
+        const int columns = int(std::ceil(std::sqrt(double(tiles.size()))));
+        const int rows = (int(tiles.size()) + columns - 1) / columns;
+        const int cellWidth = width() / columns;
+        const int cellHeight = height() / rows;
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            const int column = int(i) % columns;
+            const int row = int(i) / columns;
+            tiles[i].rect = QRect(column * cellWidth, row * cellHeight, cellWidth, cellHeight)
+                                .adjusted(kTileGap / 2, kTileGap / 2, -kTileGap / 2, -kTileGap / 2);
+            tiles[i].content = QRect();
+        }
+    }
+    update();
+}
+
+int64_t MosaicView::tileInterval(const Tile &tile, const QRegion &visible) const
+{
+    if (tile.rect.isEmpty() || !visible.intersects(tile.rect)) return -1;
+    if (tile.rect.width() < kSmallTileWidth) return int64_t(1e9 / kSmallTileFps);
+    return 0;
+}
+
+int MosaicView::refresh(StreamEngine *engine)
+{
+    const bool shown = isVisible() && !window()->isMinimized();
+    const QRegion visible = shown ? visibleRegion() : QRegion();
+
+    int drawn = 0;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        Tile &tile = tiles[i];
+        const int64_t interval = tileInterval(tile, visible);
+        if (!tile.intervalSent || interval != tile.intervalNs) {
+            engine->setTileInterval(int(i), interval);
+            tile.intervalNs = interval;
+            tile.intervalSent = true;
+        }
+        if (interval < 0) continue;
+
+        // Only streams that produced a frame since the last refresh are redrawn
+        FramePtr frame = engine->takeTileFrame(int(i));
+        if (!frame || frame->image.empty()) continue;
+        drawTile(tile, frame->image, frame->faces);
+        ++drawn;
+    }
+    return drawn;
+}
+
+void MosaicView::drawTile(Tile &tile, const cv::Mat &frame, const std::vector<FaceDetection> &faces)
+{
+    QRect content(QPoint(0, 0), QSize(frame.cols, frame.rows).scaled(tile.rect.size(), Qt::KeepAspectRatio));
+    if (content.isEmpty()) return;
+    content.moveCenter(tile.rect.center());
+
+    // A new source size moves the letterbox; clear the old bars once
+    QRect dirty = content;
+    if (content != tile.content) {
+        QPainter painter(&canvas);
+        painter.fillRect(tile.rect, Qt::black);
+        tile.content = content;
+        dirty = tile.rect;
+    }
+
+    // The tile is a view into the canvas, so scaling and overlays write in place
+    const int stride = int(canvas.bytesPerLine());
+    uchar *origin = canvas.bits() + content.y() * stride + content.x() * 3;
+    tile.scaler.scale(frame, origin, content.width(), content.height(), stride);
+    QImage view(origin, content.width(), content.height(), stride, QImage::Format_RGB888);
+    overlayPainter.paint(view, faces, double(content.width()) / frame.cols);
+
+    QPainter painter(&view);
+    painter.setPen(Qt::white);
+    painter.drawText(view.rect().adjusted(4, 0, -4, -2), Qt::AlignLeft | Qt::AlignBottom, tile.name);
+    painter.end();
+
+    update(dirty);
+}
+
+void MosaicView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.drawImage(event->rect(), canvas, event->rect());
+}
+
+void MosaicView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutTiles();
+}
@@ -0,0 +1,58 @@
+#ifndef MOSAICVIEW_H
+#define MOSAICVIEW_H
+
+#include <QImage>
+#include <QRegion>
+#include <QStringList>
+#include <QWidget>
+#include <vector>
+#include "overlaypainter.h"
+#include "previewscaler.h"
+
+class StreamEngine;
+
+// Video wall of every running stream. All tiles share one canvas the size
+// of the widget, allocated once per resize. Each refresh() takes only the
+// frames that arrived since the last one, scales them with PreviewScaler
+// straight into their tile and repaints just those tiles. Streams whose
+// tile is hidden send no frames at all. Tiles too small to show detail get
+// frames at a reduced rate, so a 6x6 wall costs little more than one stream.
+class MosaicView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MosaicView(QWidget *parent = nullptr);
+
+    // One tile per engine stream, in engine order
+    void setStreams(const QStringList &names);
+    void clear();
+
+    // Call once per display refresh; returns the number of tiles redrawn
+    int refresh(StreamEngine *engine);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    struct Tile
+    {
+        QString name;
+        QRect rect;             // Cell on the canvas
+        QRect content;          // Where the last frame went, letterboxed within rect
+        PreviewScaler scaler;   // Keeps its sampling tables while the sizes stay put
+        int64_t intervalNs = 0; // Last value given to the engine
+        bool intervalSent = false;
+    };
+
+    void layoutTiles();
+    int64_t tileInterval(const Tile &tile, const QRegion &visible) const;
+    void drawTile(Tile &tile, const cv::Mat &frame, const std::vector<FaceDetection> &faces);
+
+    QImage canvas;
+    std::vector<Tile> tiles;
+    OverlayPainter overlayPainter;
+};
+
+#endif // MOSAICVIEW_H
@@ -0,0 +1,51 @@
+#include "motiongate.h"
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Wide enough that a person entering a corridor spans many pixels
+const int kThumbnailWidth = 128;
+// Per-pixel difference that counts as change; above sensor noise after the blur
+const double kPixelThreshold = 18.0;
+// How quickly the background absorbs a changed scene
+const double kBackgroundRate = 0.05;
+
+} // namespace
+
+MotionGate::MotionGate(double areaFraction, double keepAliveMs)
+    : areaFraction(areaFraction)
+    , keepAliveNs(int64_t(keepAliveMs * 1e6))
+    , lastDetectNs(0)
+{
+}
+
+bool MotionGate::update(const cv::Mat &frame, int64_t timeNs)
+{
+    if (!enabled() || frame.empty()) return true;
+
+    // Bilinear reads only a few source pixels per output pixel, whatever the resolution
+    const int height = std::max(1, frame.rows * kThumbnailWidth / std::max(1, frame.cols));
+    cv::resize(frame, small, cv::Size(kThumbnailWidth, height), 0, 0, cv::INTER_LINEAR);
+    if (small.channels() == 3) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        small.copyTo(gray);
+    }
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0);
+    gray.convertTo(grayFloat, CV_32F);
+
+    // New camera or resolution change: start over and let detection run
+    if (background.size() != grayFloat.size()) {
+        grayFloat.copyTo(background);
+        return true;
+    }
+
+    cv::absdiff(grayFloat, background, difference);
+    cv::compare(difference, kPixelThreshold, changedMask, cv::CMP_GT);
+    const int changed = cv::countNonZero(changedMask);
+    cv::accumulateWeighted(grayFloat, background, kBackgroundRate);
+
+    if (changed >= areaFraction * gray.total()) return true;
+    return timeNs - lastDetectNs >= keepAliveNs;
+}
@@ -0,0 +1,39 @@
+#ifndef MOTIONGATE_H
+#define MOTIONGATE_H
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+// Cheap scene-change test that lets a stream skip face detection while the
+// picture is static. Each frame is shrunk to a small grayscale thumbnail and
+// compared against a running-average background; a frame counts as motion
+// when enough thumbnail pixels differ. The background adapts slowly, so
+// lighting drift does not register, while someone walking in does at once.
+class MotionGate
+{
+public:
+    // areaFraction is the share of thumbnail pixels that must change, 0 disables the gate
+    explicit MotionGate(double areaFraction = 0.002, double keepAliveMs = 2000.0);
+
+    bool enabled() const { return areaFraction > 0.0; }
+
+    // Feeds one frame; returns true if detection should run on it. Detection
+    // still runs every keepAliveMs on a static scene as a safety net.
+    bool update(const cv::Mat &frame, int64_t timeNs);
+
+    // Tells the gate detection ran, restarting the keep-alive interval
+    void onDetected(int64_t timeNs) { lastDetectNs = timeNs; }
+
+private:
+    double areaFraction;
+    int64_t keepAliveNs;
+    int64_t lastDetectNs;
+    cv::Mat small;      // Reused thumbnail buffers
+    cv::Mat gray;
+    cv::Mat grayFloat;
+    cv::Mat background; // CV_32F running average
+    cv::Mat difference;
+    cv::Mat changedMask;
+};
+
+#endif // MOTIONGATE_H
@@ -0,0 +1,17 @@
+# OpenCV include and library paths, shared by the app and the tools
+macx {
+    INCLUDEPATH += /opt/homebrew/opt/opencv/include/opencv4
+    LIBS += -L/opt/homebrew/opt/opencv/lib \
+            -lopencv_core \
+            -lopencv_highgui \
+            -lopencv_imgproc \
+            -lopencv_videoio \
+            -lopencv_imgcodecs \
+            -lopencv_video
+}
+
+# Linux servers: the distribution's opencv4.pc knows where headers and libraries are
+unix:!macx {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
@@ -0,0 +1,62 @@
+#include "overlaypainter.h"
+#include <QFontMetrics>
+#include <QPainter>
+
+OverlayPainter::OverlayPainter()
+    : boxPen(QColor(0, 255, 0), 2)
+    , labelPen(QColor(0, 255, 0))
+    , detailPen(QColor(0, 255, 255))
+{
+    font.setPointSize(9);
+    font.setBold(true);
+}
+
+void OverlayPainter::paint(QImage &image, const std::vector<FaceDetection> &faces, double scale) const
+{
+    if (faces.empty()) return;
+
+    QPainter painter(&image);
+    painter.setFont(font);
+    const int lineHeight = QFontMetrics(font).height();
+
+    for (const FaceDetection &face : faces) {
+        const QRect rect(qRound(face.rect.x * scale), qRound(face.rect.y * scale),
+                         qRound(face.rect.width * scale), qRound(face.rect.height * scale));
+        painter.setPen(boxPen);
+        painter.drawRect(rect);
+
+        // Confidence and tracking ID above the box, followed by the identity when recognised
+        painter.setPen(detailPen);
+        painter.drawText(rect.left(), rect.top() - lineHeight - 4,
+                         QString("Conf: %1").arg(face.confidence, 0, 'f', 2));
+        QString label = QString("ID: %1").arg(face.trackId);
+        if (face.identity >= 0) {
+            label += " " + face.name;
+        }
+        painter.setPen(labelPen);
+        painter.drawText(rect.left(), rect.top() - 4, label);
+
+        // Angles and whatever optional stages have run below the box
+        painter.setPen(detailPen);
+        int y = rect.bottom() + lineHeight;
+        if (face.hasAngles) {
+            painter.drawText(rect.left(), y, QString("Yaw: %1 Pitch: %2 Roll: %3")
+                             .arg(int(face.yaw)).arg(int(face.pitch)).arg(int(face.roll)));
+            y += lineHeight;
+        }
+
+        QStringList analysis;
+        if (face.analysis.stages & FaceStageLiveness) {
+            analysis << QString("Live: %1").arg(face.analysis.liveness, 0, 'f', 2);
+        }
+        if (face.analysis.stages & FaceStageMask) {
+            analysis << QString("Mask: %1").arg(face.analysis.mask, 0, 'f', 2);
+        }
+        if (face.analysis.stages & FaceStageAttribute) {
+            analysis << QString("Gender: %1 Age: %2").arg(face.analysis.gender).arg(face.analysis.ageBracket);
+        }
+        if (!analysis.isEmpty()) {
+            painter.drawText(rect.left(), y, analysis.join(' '));
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef OVERLAYPAINTER_H
+#define OVERLAYPAINTER_H
+
+#include <QFont>
+#include <QImage>
+#include <QPen>
+#include <vector>
+#include "facedetection.h"
+
+// Draws face boxes and labels onto the already-scaled preview image, so the
+// cost follows the display size rather than the source resolution and the
+// captured frame itself is never modified.
+class OverlayPainter
+{
+public:
+    OverlayPainter();
+
+    // scale maps source-frame coordinates to image coordinates
+    void paint(QImage &image, const std::vector<FaceDetection> &faces, double scale) const;
+
+private:
+    QFont font;
+    QPen boxPen;
+    QPen labelPen;
+    QPen detailPen;
+};
+
+#endif // OVERLAYPAINTER_H
@@ -0,0 +1,72 @@
+#include "pipelinemetrics.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+const char *pipelineStageName(int stage)
+{
+    static const char *const names[StageCount] = {
+        "decode", "queue", "motion", "imageStream", "track", "recognition",
+        "predict", "overlay", "total", "display"
+    };
+    return stage >= 0 && stage < StageCount ? names[stage] : "";
+}
+
+bool writeMetricsJson(const QString &path, const std::vector<PipelineMetricsSnapshot> &metrics,
+                      QString *errorMessage)
+{
+    QJsonArray streams;
+    for (const PipelineMetricsSnapshot &stream : metrics) {
+        QJsonObject stages;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            const LatencyHistogram::Snapshot &histogram = stream.stages[stage];
+            if (histogram.count == 0) continue;
+
+            QJsonObject item;
+            item["count"] = double(histogram.count);
+            item["meanMs"] = histogram.meanMs();
+            item["p50Ms"] = histogram.percentileMs(0.50);
+            item["p90Ms"] = histogram.percentileMs(0.90);
+            item["p99Ms"] = histogram.percentileMs(0.99);
+            item["maxMs"] = histogram.maxMs();
+            stages[pipelineStageName(stage)] = item;
+        }
+
+        QJsonObject item;
+        item["stream"] = stream.stream;
+        item["droppedFrames"] = double(stream.droppedFrames);
+        item["lateFrames"] = double(stream.lateFrames);
+        if (stream.startupMs >= 0) {
+            item["firstDetectMs"] = stream.firstDetectMs;
+            item["steadyDetectMs"] = stream.steadyDetectMs;
+            item["startupMs"] = stream.startupMs;
+        }
+        item["stages"] = stages;
+        streams.append(item);
+    }
+
+    QJsonObject root;
+    root["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["streams"] = streams;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) *errorMessage = QString("Tidak dapat menulis file metrics: %1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+void logStartupMetrics(const std::vector<PipelineMetricsSnapshot> &metrics)
+{
+    for (const PipelineMetricsSnapshot &stream : metrics) {
+        if (stream.startupMs < 0) continue;
+        qDebug().nospace() << "Startup " << stream.stream << ": " << qRound(stream.startupMs)
+                           << " ms hingga deteksi stabil, deteksi pertama " << stream.firstDetectMs
+                           << " ms, stabil " << stream.steadyDetectMs << " ms";
+    }
+}
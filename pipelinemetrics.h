@@ -0,0 +1,52 @@
+#ifndef PIPELINEMETRICS_H
+#define PIPELINEMETRICS_H
+
+#include <QString>
+#include <vector>
+#include "latencyhistogram.h"
+
+// Where a frame's time goes, from decode to the preview on screen
+enum PipelineStage
+{
+    StageDecode,      // VideoCapture::read on the capture thread
+    StageQueue,       // Waiting in the input queue for a worker
+    StageMotion,      // Thumbnail and background comparison of the motion gate
+    StageImageStream, // Detection resize and HFCreateImageStream
+    StageTrack,       // HFExecuteFaceTrack
+    StageRecognition, // Quality, feature extraction, gallery search and optional stages
+    StagePredict,     // Box extrapolation on frames without detection
+    StageOverlay,     // Handing the preview stream's detections to the GUI
+    StageTotal,       // Decode finished to results ready
+    StageDisplay,     // GUI thread: scaling, drawing the overlay and showing the preview
+    StageCount
+};
+
+const char *pipelineStageName(int stage);
+
+// One histogram per stage for one stream
+struct PipelineMetrics
+{
+    LatencyHistogram stages[StageCount];
+};
+
+struct PipelineMetricsSnapshot
+{
+    QString stream;
+    LatencyHistogram::Snapshot stages[StageCount];
+    uint64_t droppedFrames = 0; // Discarded by a full input queue
+    uint64_t lateFrames = 0;    // Skipped past the stream's frame-age deadline
+    // From the first full detections after start; < 0 until there are any
+    double firstDetectMs = -1.0;  // Latency of the very first detection
+    double steadyDetectMs = -1.0; // Median over the first few
+    double startupMs = -1.0;      // Start to the end of the first detection near that median
+};
+
+// Writes count, mean, p50/p90/p99/max in milliseconds per stream and stage as JSON,
+// plus each stream's dropped and late frame counts and startup figures
+bool writeMetricsJson(const QString &path, const std::vector<PipelineMetricsSnapshot> &metrics,
+                      QString *errorMessage = nullptr);
+
+// One log line per stream with its startup figures, for streams that have any
+void logStartupMetrics(const std::vector<PipelineMetricsSnapshot> &metrics);
+
+#endif // PIPELINEMETRICS_H
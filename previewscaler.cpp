@@ -0,0 +1,218 @@
+#include "previewscaler.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PREVIEWSCALER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Output rows are RGB, source rows BGR; both average functions round like pavgb
+
+void averageRowsScalar(const uint8_t *a, const uint8_t *b, uint8_t *out, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = uint8_t((a[i] + b[i] + 1) >> 1);
+    }
+}
+
+void resampleRowScalar(const uint8_t *row, const int32_t *xofs0, const int32_t *xofs1,
+                       uint8_t *dst, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const uint8_t *p0 = row + xofs0[x];
+        const uint8_t *p1 = row + xofs1[x];
+        dst[3 * x + 0] = uint8_t((p0[2] + p1[2] + 1) >> 1);
+        dst[3 * x + 1] = uint8_t((p0[1] + p1[1] + 1) >> 1);
+        dst[3 * x + 2] = uint8_t((p0[0] + p1[0] + 1) >> 1);
+    }
+}
+
+#ifdef PREVIEWSCALER_X86
+
+inline int load32(const uint8_t *p)
+{
+    int value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+__attribute__((target("sse4.1")))
+void averageRowsSse41(const uint8_t *a, const uint8_t *b, uint8_t *out, int bytes)
+{
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_avg_epu8(va, vb));
+    }
+    averageRowsScalar(a + i, b + i, out + i, bytes - i);
+}
+
+__attribute__((target("sse4.1")))
+void resampleRowSse41(const uint8_t *row, const int32_t *xofs0, const int32_t *xofs1,
+                      uint8_t *dst, int width)
+{
+    // Four BGRx pixels per register, packed down to 12 bytes of RGB
+    const __m128i toRgb = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    // Every store writes 16 bytes for 12 useful ones, so stop two pixels early
+    int x = 0;
+    for (; x + 6 <= width; x += 4) {
+        const __m128i p0 = _mm_setr_epi32(load32(row + xofs0[x]), load32(row + xofs0[x + 1]),
+                                          load32(row + xofs0[x + 2]), load32(row + xofs0[x + 3]));
+        const __m128i p1 = _mm_setr_epi32(load32(row + xofs1[x]), load32(row + xofs1[x + 1]),
+                                          load32(row + xofs1[x + 2]), load32(row + xofs1[x + 3]));
+        const __m128i rgb = _mm_shuffle_epi8(_mm_avg_epu8(p0, p1), toRgb);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * x), rgb);
+    }
+    resampleRowScalar(row, xofs0 + x, xofs1 + x, dst + 3 * x, width - x);
+}
+
+__attribute__((target("avx2")))
+void averageRowsAvx2(const uint8_t *a, const uint8_t *b, uint8_t *out, int bytes)
+{
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_avg_epu8(va, vb));
+    }
+    averageRowsScalar(a + i, b + i, out + i, bytes - i);
+}
+
+__attribute__((target("avx2")))
+void resampleRowAvx2(const uint8_t *row, const int32_t *xofs0, const int32_t *xofs1,
+                     uint8_t *dst, int width)
+{
+    const __m256i toRgb = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                           2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const int *base = reinterpret_cast<const int *>(row);
+
+    // Two overlapping 16-byte stores per 8 pixels; the second ends 10 pixels in
+    int x = 0;
+    for (; x + 10 <= width; x += 8) {
+        const __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xofs0 + x));
+        const __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xofs1 + x));
+        const __m256i p0 = _mm256_i32gather_epi32(base, i0, 1);
+        const __m256i p1 = _mm256_i32gather_epi32(base, i1, 1);
+        const __m256i rgb = _mm256_shuffle_epi8(_mm256_avg_epu8(p0, p1), toRgb);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * x), _mm256_castsi256_si128(rgb));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * x + 12), _mm256_extracti128_si256(rgb, 1));
+    }
+    resampleRowScalar(row, xofs0 + x, xofs1 + x, dst + 3 * x, width - x);
+}
+
+#endif // PREVIEWSCALER_X86
+
+} // namespace
+
+PreviewScaler::PreviewScaler(Kernel kernel)
+    : activeKernel(Scalar)
+    , averageRows(averageRowsScalar)
+    , resampleRow(resampleRowScalar)
+    , srcWidth(0)
+    , srcHeight(0)
+    , dstWidth(0)
+    , dstHeight(0)
+{
+    if (kernel == Auto) {
+        kernel = isSupported(Avx2) ? Avx2 : isSupported(Sse41) ? Sse41 : Scalar;
+    }
+    if (!isSupported(kernel)) {
+        kernel = Scalar;
+    }
+
+#ifdef PREVIEWSCALER_X86
+    if (kernel == Avx2) {
+        averageRows = averageRowsAvx2;
+        resampleRow = resampleRowAvx2;
+    } else if (kernel == Sse41) {
+        averageRows = averageRowsSse41;
+        resampleRow = resampleRowSse41;
+    }
+#endif
+    activeKernel = kernel;
+}
+
+bool PreviewScaler::isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Auto:
+    case Scalar:
+        return true;
+#ifdef PREVIEWSCALER_X86
+    case Sse41:
+        return __builtin_cpu_supports("sse4.1");
+    case Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *PreviewScaler::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Scalar: return "scalar";
+    case Sse41: return "sse4.1";
+    case Avx2: return "avx2";
+    default: return "auto";
+    }
+}
+
+void PreviewScaler::prepare(int width, int height, int targetWidth, int targetHeight)
+{
+    if (width == srcWidth && height == srcHeight && targetWidth == dstWidth && targetHeight == dstHeight) {
+        return;
+    }
+    srcWidth = width;
+    srcHeight = height;
+    dstWidth = targetWidth;
+    dstHeight = targetHeight;
+
+    // Two samples per output pixel and axis, at 1/4 and 3/4 of its source footprint
+    xofs0.resize(dstWidth);
+    xofs1.resize(dstWidth);
+    for (int x = 0; x < dstWidth; ++x) {
+        xofs0[x] = 3 * std::min(srcWidth - 1, int((x + 0.25) * srcWidth / dstWidth));
+        xofs1[x] = 3 * std::min(srcWidth - 1, int((x + 0.75) * srcWidth / dstWidth));
+    }
+    yofs0.resize(dstHeight);
+    yofs1.resize(dstHeight);
+    for (int y = 0; y < dstHeight; ++y) {
+        yofs0[y] = std::min(srcHeight - 1, int((y + 0.25) * srcHeight / dstHeight));
+        yofs1[y] = std::min(srcHeight - 1, int((y + 0.75) * srcHeight / dstHeight));
+    }
+
+    // The SIMD gathers read 4 bytes per 3-byte pixel, so pad past the last one
+    rowBuffer.assign(size_t(srcWidth) * 3 + 32, 0);
+}
+
+void PreviewScaler::scale(const cv::Mat &bgr, uint8_t *dst, int width, int height, int dstStride)
+{
+    if (bgr.empty() || bgr.type() != CV_8UC3 || width <= 0 || height <= 0) return;
+
+    prepare(bgr.cols, bgr.rows, width, height);
+    const int rowBytes = srcWidth * 3;
+    int bufferedRows[2] = { -1, -1 };
+
+    for (int y = 0; y < dstHeight; ++y) {
+        // Upscaled or repeated rows reuse the blended row from the previous iteration
+        if (yofs0[y] != bufferedRows[0] || yofs1[y] != bufferedRows[1]) {
+            const uint8_t *row0 = bgr.ptr<uint8_t>(yofs0[y]);
+            const uint8_t *row1 = bgr.ptr<uint8_t>(yofs1[y]);
+            if (row0 == row1) {
+                std::memcpy(rowBuffer.data(), row0, rowBytes);
+            } else {
+                averageRows(row0, row1, rowBuffer.data(), rowBytes);
+            }
+            bufferedRows[0] = yofs0[y];
+            bufferedRows[1] = yofs1[y];
+        }
+        resampleRow(rowBuffer.data(), xofs0.data(), xofs1.data(), dst + size_t(y) * dstStride, dstWidth);
+    }
+}
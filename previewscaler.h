@@ -0,0 +1,48 @@
+#ifndef PREVIEWSCALER_H
+#define PREVIEWSCALER_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+
+// Downscales a BGR frame straight into a caller-owned RGB888 buffer in one
+// pass. Each output pixel averages a 2x2 set of source samples spread over
+// its footprint. The inner loops are vectorised with SSE4.1 or AVX2, picked at
+// runtime, with a scalar fallback for other CPUs.
+class PreviewScaler
+{
+public:
+    enum Kernel { Auto, Scalar, Sse41, Avx2 };
+
+    explicit PreviewScaler(Kernel kernel = Auto);
+
+    // dst must hold height rows of dstStride bytes; width * 3 bytes are written per row
+    void scale(const cv::Mat &bgr, uint8_t *dst, int width, int height, int dstStride);
+
+    Kernel kernel() const { return activeKernel; }
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+private:
+    typedef void (*AverageRowsFn)(const uint8_t *a, const uint8_t *b, uint8_t *out, int bytes);
+    typedef void (*ResampleRowFn)(const uint8_t *row, const int32_t *xofs0, const int32_t *xofs1,
+                                  uint8_t *dst, int width);
+
+    void prepare(int width, int height, int targetWidth, int targetHeight);
+
+    Kernel activeKernel;
+    AverageRowsFn averageRows;
+    ResampleRowFn resampleRow;
+
+    int srcWidth;
+    int srcHeight;
+    int dstWidth;
+    int dstHeight;
+    std::vector<int32_t> xofs0;
+    std::vector<int32_t> xofs1;
+    std::vector<int> yofs0;
+    std::vector<int> yofs1;
+    std::vector<uint8_t> rowBuffer;
+};
+
+#endif // PREVIEWSCALER_H
@@ -0,0 +1,126 @@
+#include "sessionpool.h"
+#include "facedetection.h"
+#include <QDebug>
+
+HFSessionCustomParameter sessionParameter(unsigned stages)
+{
+    HFSessionCustomParameter param;
+    param.enable_recognition = 1;
+    param.enable_liveness = (stages & FaceStageLiveness) ? 1 : 0;
+    param.enable_mask_detect = (stages & FaceStageMask) ? 1 : 0;
+    param.enable_face_attribute = (stages & FaceStageAttribute) ? 1 : 0;
+    param.enable_face_quality = 1;
+    param.enable_ir_liveness = 0;
+    param.enable_interaction_liveness = 0;
+    param.enable_detect_mode_landmark = 1;
+    return param;
+}
+
+HInt32 pipelineOption(unsigned stages)
+{
+    HInt32 option = HF_ENABLE_NONE;
+    if (stages & FaceStageLiveness) option |= HF_ENABLE_LIVENESS;
+    if (stages & FaceStageMask) option |= HF_ENABLE_MASK_DETECT;
+    if (stages & FaceStageAttribute) option |= HF_ENABLE_FACE_ATTRIBUTE;
+    return option;
+}
+
+HFSession createSession(const SessionSettings &settings, HResult *result)
+{
+    HFSession session = nullptr;
+    HResult ret = HFCreateInspireFaceSession(settings.param, settings.detectMode,
+                                             settings.maxDetectFaces, settings.detectPixelLevel, 0, &session);
+    if (result) *result = ret;
+    if (ret != HSUCCEED) return nullptr;
+
+    // Set detection parameters
+    HFSessionSetFaceDetectThreshold(session, settings.faceDetectThreshold);
+    HFSessionSetTrackModeSmoothRatio(session, settings.trackSmoothRatio);
+    HFSessionSetFilterMinimumFacePixelSize(session, settings.minimumFacePixelSize);
+    return session;
+}
+
+SessionPool::SessionPool()
+    : hint(0)
+{
+}
+
+SessionPool::~SessionPool()
+{
+    releaseAll();
+}
+
+bool SessionPool::grow(int count, const SessionSettings &settings, HResult *result,
+                       std::vector<HFSession> *added)
+{
+    if (available() != size()) {
+        qDebug() << "Peringatan: pool tidak dapat diperbesar selama session dipakai";
+        return false;
+    }
+
+    std::vector<HFSession> created;
+    while (int(sessions.size() + created.size()) < count) {
+        HFSession session = createSession(settings, result);
+        if (!session) {
+            for (HFSession unused : created) HFReleaseInspireFaceSession(unused);
+            return false;
+        }
+        created.push_back(session);
+    }
+    if (created.empty()) return true;
+
+    sessions.insert(sessions.end(), created.begin(), created.end());
+    inUse.reset(new std::atomic<bool>[sessions.size()]);
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        inUse[i].store(false, std::memory_order_relaxed);
+    }
+    if (added) *added = created;
+    qDebug() << "Session pool diperbesar menjadi" << sessions.size() << "session";
+    return true;
+}
+
+void SessionPool::releaseAll()
+{
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        if (inUse[i].load(std::memory_order_acquire)) {
+            qDebug() << "Peringatan: session" << i << "masih dipakai saat pool dilepas";
+        }
+        HFReleaseInspireFaceSession(sessions[i]);
+    }
+    sessions.clear();
+    inUse.reset();
+}
+
+int SessionPool::available() const
+{
+    int count = 0;
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        if (!inUse[i].load(std::memory_order_relaxed)) ++count;
+    }
+    return count;
+}
+
+HFSession SessionPool::acquire()
+{
+    // Start from a rotating slot so concurrent callers rarely race for the same flag
+    const size_t count = sessions.size();
+    const size_t first = hint.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = (first + i) % count;
+        bool expected = false;
+        if (inUse[index].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return sessions[index];
+        }
+    }
+    return nullptr;
+}
+
+void SessionPool::giveBack(HFSession session)
+{
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        if (sessions[i] == session) {
+            inUse[i].store(false, std::memory_order_release);
+            return;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <inspireface.h>
+
+struct SessionSettings
+{
+    HFSessionCustomParameter param;
+    HFDetectMode detectMode = HF_DETECT_MODE_LIGHT_TRACK;
+    int maxDetectFaces = 20;
+    int detectPixelLevel = 320;
+    float faceDetectThreshold = 0.7f;
+    float trackSmoothRatio = 0.7f;
+    int minimumFacePixelSize = 60;
+};
+
+// Session parameters with tracking, recognition and quality always on and
+// the models for the optional FaceStage flags loaded only when asked for
+HFSessionCustomParameter sessionParameter(unsigned stages);
+
+// FaceStage flags as the option mask of HFMultipleFacePipelineProcessOptional
+HInt32 pipelineOption(unsigned stages);
+
+HFSession createSession(const SessionSettings &settings, HResult *result = nullptr);
+
+// Set of InspireFace sessions created up front by grow(). acquire() and
+// giveBack() only touch per-slot atomic flags, so workers never serialise
+// on a shared lock to get a session.
+class SessionPool
+{
+public:
+    SessionPool();
+    ~SessionPool();
+
+    SessionPool(const SessionPool &) = delete;
+    SessionPool &operator=(const SessionPool &) = delete;
+
+    // Adds sessions until the pool holds count; the new ones go to added when
+    // given. Only while no session is handed out.
+    bool grow(int count, const SessionSettings &settings, HResult *result = nullptr,
+              std::vector<HFSession> *added = nullptr);
+    void releaseAll();
+
+    int size() const { return int(sessions.size()); }
+    int available() const;
+
+    // Returns nullptr when every session is handed out
+    HFSession acquire();
+    void giveBack(HFSession session);
+
+private:
+    std::vector<HFSession> sessions;
+    std::unique_ptr<std::atomic<bool>[]> inUse;
+    std::atomic<unsigned> hint;
+};
+
+#endif // SESSIONPOOL_H
@@ -0,0 +1,372 @@
+#include "sightingslog.h"
+#include "latencyhistogram.h"
+#include <QByteArray>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// "SGT2"; SGT1 blocks stored gallery indices, which no longer resolve, and are skipped
+const uint32_t kBlockMagic = 0x32544753;
+const char kNamesFile[] = "identities.tsv";
+const int64_t kSegmentMs = 3600 * 1000;
+// A track unseen for this long is over; the tracker keeps IDs across short gaps
+const int64_t kTrackLostNs = 2000 * int64_t(1000000);
+// Pending sightings are written at least this often, or once a block is full
+const int kFlushIntervalMs = 1000;
+const size_t kMaxBlockRecords = 4096;
+
+// Precedes every block in the segment and is repeated in the .idx file
+struct BlockHeader
+{
+    uint32_t magic;
+    uint32_t count;
+    int64_t minFirstMs;
+    int64_t maxLastMs;
+    uint64_t streamMask; // Bit streamId % 64 of every stream in the block
+};
+
+struct IndexEntry
+{
+    uint64_t offset; // Of the block header in the segment
+    BlockHeader header;
+};
+
+static_assert(sizeof(SightingRecord) == 64, "SightingRecord is an on-disk format");
+static_assert(sizeof(IndexEntry) == 40, "IndexEntry is an on-disk format");
+
+int64_t segmentStart(int64_t timeMs)
+{
+    return timeMs - ((timeMs % kSegmentMs) + kSegmentMs) % kSegmentMs;
+}
+
+QString segmentBase(const QString &directory, int64_t segmentMs)
+{
+    const QString hour = QDateTime::fromMSecsSinceEpoch(segmentMs, Qt::UTC).toString("yyyyMMdd-HH");
+    return QDir(directory).filePath("sightings-" + hour);
+}
+
+uint64_t streamBit(uint32_t id)
+{
+    return uint64_t(1) << (id % 64);
+}
+
+} // namespace
+
+SightingsLog::SightingsLog()
+    : wallOffsetMs(0)
+    , stopping(false)
+    , written(0)
+{
+}
+
+SightingsLog::~SightingsLog()
+{
+    stop();
+}
+
+uint32_t SightingsLog::streamId(const QString &name)
+{
+    // FNV-1a over UTF-8
+    uint32_t hash = 2166136261u;
+    const QByteArray bytes = name.toUtf8();
+    for (char c : bytes) {
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t SightingsLog::identityId(const QString &name)
+{
+    if (name.isEmpty()) return 0;
+    return std::max(1u, streamId(name));
+}
+
+QHash<uint32_t, QString> SightingsLog::identityNames(const QString &directory)
+{
+    QHash<uint32_t, QString> names;
+    QFile file(QDir(directory).filePath(kNamesFile));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return names;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const int tab = line.indexOf('\t');
+        if (tab <= 0) continue;
+        bool ok = false;
+        const uint32_t id = line.left(tab).toUInt(&ok);
+        if (ok) names.insert(id, line.mid(tab + 1));
+    }
+    return names;
+}
+
+void SightingsLog::start(const QStringList &streamNames)
+{
+    stop();
+    if (!enabled() || streamNames.isEmpty()) return;
+
+    if (!QDir().mkpath(directory)) {
+        qDebug() << "Tidak dapat membuat direktori sightings:" << directory;
+    }
+    wallOffsetMs = QDateTime::currentMSecsSinceEpoch() - LatencyHistogram::nowNs() / 1000000;
+    written.store(0, std::memory_order_relaxed);
+    pendingNames.clear();
+    knownNames.clear();
+    const QHash<uint32_t, QString> names = identityNames(directory);
+    for (auto it = names.constBegin(); it != names.constEnd(); ++it) {
+        knownNames.insert(it.key());
+    }
+    for (const QString &name : streamNames) {
+        StreamState state;
+        state.id = streamId(name);
+        streams.push_back(state);
+    }
+    stopping = false;
+    writer = std::thread(&SightingsLog::writerLoop, this);
+}
+
+void SightingsLog::stop()
+{
+    if (streams.empty()) return;
+
+    // Workers have stopped calling onFrame; whatever is still open ends now
+    for (StreamState &state : streams) {
+        for (const OpenTrack &track : state.tracks) {
+            close(track);
+        }
+    }
+    streams.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void SightingsLog::onFrame(int stream, int64_t timeNs, const std::vector<FaceDetection> &faces, int64_t eventMs)
+{
+    if (stream < 0 || stream >= int(streams.size())) return;
+
+    StreamState &state = streams[stream];
+    const int64_t nowMs = wallOffsetMs + timeNs / 1000000;
+    for (const FaceDetection &face : faces) {
+        auto track = std::find_if(state.tracks.begin(), state.tracks.end(),
+                                  [&face](const OpenTrack &open) { return open.record.trackId == face.trackId; });
+        if (track == state.tracks.end()) {
+            OpenTrack open;
+            open.record = SightingRecord{nowMs, nowMs, 0, state.id, face.trackId, 0, 0,
+                                         0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0};
+            state.tracks.push_back(open);
+            track = state.tracks.end() - 1;
+        }
+
+        SightingRecord &record = track->record;
+        track->lastSeenNs = timeNs;
+        record.lastMs = nowMs;
+        ++record.frames;
+        if (face.identity >= 0 && face.name != track->name) {
+            track->name = face.name;
+            record.identityId = identityId(face.name);
+        }
+        if (record.eventMs == 0) record.eventMs = eventMs;
+
+        // Extrapolated boxes carry no new measurement
+        if (!face.predicted) {
+            record.confidence = std::max(record.confidence, face.confidence);
+            if (face.quality > record.quality) {
+                record.quality = face.quality;
+                record.yaw = face.yaw;
+                record.pitch = face.pitch;
+                record.roll = face.roll;
+            }
+        }
+
+        // Split very long tracks so no record reaches back more than one segment
+        if (record.lastMs - record.firstMs >= kSegmentMs) {
+            // The next piece keeps the track and identity but measures, and finds its event, afresh
+            close(*track);
+            record.firstMs = nowMs;
+            record.eventMs = 0;
+            record.frames = 0;
+            record.confidence = 0.0f;
+            record.quality = -1.0f;
+            record.yaw = 0.0f;
+            record.pitch = 0.0f;
+            record.roll = 0.0f;
+        }
+    }
+
+    // Close tracks the tracker has let go of
+    auto lost = std::remove_if(state.tracks.begin(), state.tracks.end(), [this, timeNs](const OpenTrack &open) {
+        if (timeNs - open.lastSeenNs <= kTrackLostNs) return false;
+        close(open);
+        return true;
+    });
+    state.tracks.erase(lost, state.tracks.end());
+}
+
+void SightingsLog::close(const OpenTrack &track)
+{
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const uint32_t id = track.record.identityId;
+        if (id != 0 && !knownNames.contains(id)) {
+            knownNames.insert(id);
+            pendingNames.insert(id, track.name);
+        }
+        pending.push_back(track.record);
+        full = pending.size() >= kMaxBlockRecords;
+    }
+    if (full) wake.notify_one();
+}
+
+void SightingsLog::writerLoop()
+{
+    std::vector<SightingRecord> batch;
+    QHash<uint32_t, QString> names;
+    for (;;) {
+        bool done;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs), [this]() {
+                return stopping || pending.size() >= kMaxBlockRecords;
+            });
+            batch.swap(pending);
+            names.swap(pendingNames);
+            done = stopping && batch.empty();
+        }
+        if (done) return;
+        if (batch.empty()) continue;
+
+        // Names first, so no record on disk refers to an id the table lacks
+        if (!names.isEmpty()) {
+            writeNames(names);
+            names.clear();
+        }
+
+        writeBlock(batch);
+        written.fetch_add(batch.size(), std::memory_order_relaxed);
+        batch.clear();
+    }
+}
+
+void SightingsLog::writeNames(const QHash<uint32_t, QString> &names)
+{
+    QFile file(QDir(directory).filePath(kNamesFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Gagal menulis nama identitas sightings:" << file.fileName();
+        return;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    for (auto it = names.constBegin(); it != names.constEnd(); ++it) {
+        out << it.key() << '\t' << it.value() << '\n';
+    }
+}
+
+void SightingsLog::writeBlock(const std::vector<SightingRecord> &records)
+{
+    // One block per segment touched; batches rarely straddle an hour
+    std::vector<SightingRecord> sorted(records);
+    std::sort(sorted.begin(), sorted.end(), [](const SightingRecord &a, const SightingRecord &b) {
+        return a.lastMs < b.lastMs;
+    });
+
+    size_t begin = 0;
+    while (begin < sorted.size()) {
+        const int64_t segment = segmentStart(sorted[begin].lastMs);
+        size_t end = begin;
+        BlockHeader header = { kBlockMagic, 0, sorted[begin].firstMs, sorted[begin].lastMs, 0 };
+        while (end < sorted.size() && segmentStart(sorted[end].lastMs) == segment) {
+            header.minFirstMs = std::min(header.minFirstMs, sorted[end].firstMs);
+            header.maxLastMs = std::max(header.maxLastMs, sorted[end].lastMs);
+            header.streamMask |= streamBit(sorted[end].streamId);
+            ++end;
+        }
+        header.count = uint32_t(end - begin);
+
+        const QString base = segmentBase(directory, segment);
+        QFile data(base + ".log");
+        QFile index(base + ".idx");
+        if (!data.open(QIODevice::WriteOnly | QIODevice::Append)
+            || !index.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qDebug() << "Gagal menulis sightings:" << data.fileName();
+            begin = end;
+            continue;
+        }
+
+        // The index entry goes in only after the block, so it never points at a torn write
+        const IndexEntry entry = { uint64_t(data.size()), header };
+        const qint64 bytes = qint64(header.count * sizeof(SightingRecord));
+        if (data.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+            && data.write(reinterpret_cast<const char *>(&sorted[begin]), bytes) == bytes && data.flush()) {
+            index.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        }
+        begin = end;
+    }
+}
+
+bool SightingsLog::query(const QString &directory, const QString &stream, int64_t fromMs, int64_t toMs,
+                         std::vector<SightingRecord> *results, QString *errorMessage)
+{
+    results->clear();
+    if (toMs < fromMs) return true;
+    if (!QDir(directory).exists()) {
+        if (errorMessage) *errorMessage = QString("Direktori sightings tidak ditemukan: %1").arg(directory);
+        return false;
+    }
+
+    const bool anyStream = stream.isEmpty();
+    const uint32_t id = anyStream ? 0 : streamId(stream);
+
+    // Records live in the segment of their last sighting and span at most one segment
+    for (int64_t segment = segmentStart(fromMs); segment <= toMs + kSegmentMs; segment += kSegmentMs) {
+        const QString base = segmentBase(directory, segment);
+        QFile index(base + ".idx");
+        if (!index.open(QIODevice::ReadOnly)) continue;
+        const QByteArray entries = index.readAll();
+
+        QFile data(base + ".log");
+        if (!data.open(QIODevice::ReadOnly)) {
+            if (errorMessage) *errorMessage = QString("Segmen sightings tidak dapat dibaca: %1").arg(data.fileName());
+            return false;
+        }
+
+        std::vector<SightingRecord> block;
+        const size_t entryCount = size_t(entries.size()) / sizeof(IndexEntry);
+        for (size_t i = 0; i < entryCount; ++i) {
+            IndexEntry entry;
+            memcpy(&entry, entries.constData() + i * sizeof(IndexEntry), sizeof(entry));
+            const BlockHeader &header = entry.header;
+            if (header.magic != kBlockMagic || header.minFirstMs > toMs || header.maxLastMs < fromMs) continue;
+            if (!anyStream && !(header.streamMask & streamBit(id))) continue;
+
+            block.resize(header.count);
+            const qint64 bytes = qint64(header.count * sizeof(SightingRecord));
+            if (!data.seek(qint64(entry.offset + sizeof(BlockHeader)))
+                || data.read(reinterpret_cast<char *>(block.data()), bytes) != bytes) {
+                if (errorMessage) *errorMessage = QString("Segmen sightings rusak: %1").arg(data.fileName());
+                return false;
+            }
+            for (const SightingRecord &record : block) {
+                if (record.firstMs > toMs || record.lastMs < fromMs) continue;
+                if (!anyStream && record.streamId != id) continue;
+                results->push_back(record);
+            }
+        }
+    }
+
+    std::sort(results->begin(), results->end(), [](const SightingRecord &a, const SightingRecord &b) {
+        return a.firstMs < b.firstMs;
+    });
+    return true;
+}
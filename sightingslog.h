@@ -0,0 +1,114 @@
+#ifndef SIGHTINGSLOG_H
+#define SIGHTINGSLOG_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "facedetection.h"
+
+// One track from first to last sighting. Stored as-is (host byte order) in
+// the log, so the layout must not change without bumping the format.
+struct SightingRecord
+{
+    int64_t firstMs;     // Wall clock, ms since the epoch
+    int64_t lastMs;
+    int64_t eventMs;     // Start of the EventRecorder event with the track's crop, 0 = none
+    uint32_t streamId;   // SightingsLog::streamId() of the stream name
+    int32_t trackId;
+    uint32_t identityId; // SightingsLog::identityId() of the last matched name, 0 = unknown
+    uint32_t frames;     // Frames the track was seen in
+    float confidence;    // Best detection confidence
+    float quality;       // Best quality score, < 0 when never measured
+    float yaw;           // Angles of the best-quality view
+    float pitch;
+    float roll;
+    uint32_t reserved;
+};
+
+// Append-only audit trail of every track the engine has seen. Finished
+// tracks are handed to a background thread that writes them in blocks to
+// hourly segment files, sightings-YYYYMMDD-HH.log (UTC, by last sighting).
+// Every block starts with a header carrying its record count, time range
+// and a 64-bit stream bitmask, and the same header is appended to a small
+// .idx file beside the segment. A query reads only the index entries of the
+// segments that can overlap the range, then only the matching blocks.
+// Tracks longer than an hour are split, so a segment never holds a sighting
+// that started more than an hour before it. Gallery names are kept once
+// per directory in identities.tsv ("id<TAB>name" lines), appended before the
+// first block that refers to them.
+class SightingsLog
+{
+public:
+    SightingsLog();
+    ~SightingsLog();
+
+    SightingsLog(const SightingsLog &) = delete;
+    SightingsLog &operator=(const SightingsLog &) = delete;
+
+    // Empty disables the log; takes effect on the next start()
+    void setDirectory(const QString &path) { directory = path; }
+    bool enabled() const { return !directory.isEmpty(); }
+
+    void start(const QStringList &streamNames);
+    // Closes every open track and returns once all of them are on disk
+    void stop();
+
+    // Called by the worker that holds stream, with the frame's steady-clock time.
+    // eventMs is the recorder event open on the stream, 0 when none.
+    void onFrame(int stream, int64_t timeNs, const std::vector<FaceDetection> &faces, int64_t eventMs);
+
+    uint64_t sightingsWritten() const { return written.load(std::memory_order_relaxed); }
+
+    // Stable across runs and processes, unlike qHash
+    static uint32_t streamId(const QString &name);
+    // Same hash for a gallery name; never 0, which marks an unknown face.
+    // Unlike a gallery index it survives gallery edits, restarts and model swaps.
+    static uint32_t identityId(const QString &name);
+    // identities.tsv of directory; empty when there is none
+    static QHash<uint32_t, QString> identityNames(const QString &directory);
+
+    // Sightings on stream overlapping [fromMs, toMs]; an empty stream matches all
+    static bool query(const QString &directory, const QString &stream, int64_t fromMs, int64_t toMs,
+                      std::vector<SightingRecord> *results, QString *errorMessage = nullptr);
+
+private:
+    struct OpenTrack
+    {
+        SightingRecord record;
+        QString name; // Last matched gallery name
+        int64_t lastSeenNs;
+    };
+
+    struct StreamState
+    {
+        uint32_t id;
+        std::vector<OpenTrack> tracks; // Worker only
+    };
+
+    void close(const OpenTrack &track);
+    void writerLoop();
+    void writeNames(const QHash<uint32_t, QString> &names);
+    void writeBlock(const std::vector<SightingRecord> &records);
+
+    QString directory;
+    int64_t wallOffsetMs; // Wall clock minus steady clock, fixed at start()
+    std::vector<StreamState> streams;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<SightingRecord> pending;
+    QHash<uint32_t, QString> pendingNames; // Not yet in identities.tsv
+    QSet<uint32_t> knownNames;             // Already in identities.tsv or pendingNames
+    bool stopping;
+    std::atomic<uint64_t> written;
+};
+
+#endif // SIGHTINGSLOG_H
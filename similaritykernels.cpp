@@ -0,0 +1,122 @@
+#include "similaritykernels.h"
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMILARITYKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*DotRowsFn)(const float *query, const float *rows, int count, int stride, float *scores);
+typedef float (*DotProductFn)(const float *a, const float *b, int stride);
+
+float dotProductScalar(const float *a, const float *b, int stride)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < stride; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void dotRowsScalar(const float *query, const float *rows, int count, int stride, float *scores)
+{
+    for (int r = 0; r < count; ++r) {
+        scores[r] = dotProductScalar(query, rows + size_t(r) * stride, stride);
+    }
+}
+
+#ifdef SIMILARITYKERNELS_X86
+
+__attribute__((target("avx2,fma")))
+inline float horizontalSum(__m256 v)
+{
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma")))
+float dotProductAvx2(const float *a, const float *b, int stride)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= stride; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i < stride) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    return horizontalSum(_mm256_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx2,fma")))
+void dotRowsAvx2(const float *query, const float *rows, int count, int stride, float *scores)
+{
+    // Four rows per pass share each query load and keep four FMA chains in flight
+    int r = 0;
+    for (; r + 4 <= count; r += 4) {
+        const float *row0 = rows + size_t(r) * stride;
+        const float *row1 = row0 + stride;
+        const float *row2 = row1 + stride;
+        const float *row3 = row2 + stride;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        for (int i = 0; i < stride; i += 8) {
+            const __m256 q = _mm256_loadu_ps(query + i);
+            acc0 = _mm256_fmadd_ps(q, _mm256_loadu_ps(row0 + i), acc0);
+            acc1 = _mm256_fmadd_ps(q, _mm256_loadu_ps(row1 + i), acc1);
+            acc2 = _mm256_fmadd_ps(q, _mm256_loadu_ps(row2 + i), acc2);
+            acc3 = _mm256_fmadd_ps(q, _mm256_loadu_ps(row3 + i), acc3);
+        }
+        scores[r] = horizontalSum(acc0);
+        scores[r + 1] = horizontalSum(acc1);
+        scores[r + 2] = horizontalSum(acc2);
+        scores[r + 3] = horizontalSum(acc3);
+    }
+    for (; r < count; ++r) {
+        scores[r] = dotProductAvx2(query, rows + size_t(r) * stride, stride);
+    }
+}
+
+#endif // SIMILARITYKERNELS_X86
+
+bool hasAvx2()
+{
+#ifdef SIMILARITYKERNELS_X86
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+#ifdef SIMILARITYKERNELS_X86
+const DotRowsFn dotRowsKernel = hasAvx2() ? dotRowsAvx2 : dotRowsScalar;
+const DotProductFn dotProductKernel = hasAvx2() ? dotProductAvx2 : dotProductScalar;
+#else
+const DotRowsFn dotRowsKernel = dotRowsScalar;
+const DotProductFn dotProductKernel = dotProductScalar;
+#endif
+
+} // namespace
+
+void dotRows(const float *query, const float *rows, int count, int stride, float *scores)
+{
+    dotRowsKernel(query, rows, count, stride, scores);
+}
+
+float dotProduct(const float *a, const float *b, int stride)
+{
+    return dotProductKernel(a, b, stride);
+}
+
+const char *similarityKernelName()
+{
+    return hasAvx2() ? "avx2+fma" : "scalar";
+}
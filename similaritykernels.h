@@ -0,0 +1,15 @@
+#ifndef SIMILARITYKERNELS_H
+#define SIMILARITYKERNELS_H
+
+// Dot products between zero-padded float rows whose stride is a multiple of
+// 8. The AVX2/FMA versions are used when the CPU supports them, scalar
+// loops otherwise; the choice is made once at startup.
+
+// scores[r] = dot(query, rows + r * stride) for r in [0, count)
+void dotRows(const float *query, const float *rows, int count, int stride, float *scores);
+
+float dotProduct(const float *a, const float *b, int stride);
+
+const char *similarityKernelName();
+
+#endif // SIMILARITYKERNELS_H
@@ -0,0 +1,124 @@
+#include "streamconfig.h"
+#include <algorithm>
+
+static const char *const dropPolicyNames[] = { "oldest", "newest", "keyframes" };
+
+static FrameDropPolicy dropPolicyFromString(const QString &name)
+{
+    for (int i = 0; i < 3; ++i) {
+        if (name == dropPolicyNames[i]) return FrameDropPolicy(i);
+    }
+    return DropOldest;
+}
+
+StreamConfig StreamConfig::fromJson(const QJsonObject &obj)
+{
+    StreamConfig config;
+    config.name = obj["name"].toString();
+    config.url = obj["url"].toString();
+    config.enabled = obj["enabled"].toBool(true);
+    config.detectWidth = obj["detectWidth"].toInt(0);
+    config.targetLatencyMs = obj["targetLatencyMs"].toDouble(33.0);
+    config.maxDetectInterval = obj["maxDetectInterval"].toInt(5);
+    config.replayFps = obj["replayFps"].toDouble(0.0);
+    config.replayLoops = obj["replayLoops"].toInt(1);
+    config.reconnectAttempts = obj["reconnectAttempts"].toInt(0);
+    config.reconnectMaxDelayMs = obj["reconnectMaxDelayMs"].toInt(30000);
+    config.connectTimeoutMs = obj["connectTimeoutMs"].toInt(5000);
+    config.queueSize = std::max(1, obj["queueSize"].toInt(1));
+    config.dropPolicy = dropPolicyFromString(obj["dropPolicy"].toString());
+    config.maxFrameAgeMs = obj["maxFrameAgeMs"].toDouble(0.0);
+    config.motionThreshold = obj["motionThreshold"].toDouble(0.002);
+    config.motionKeepAliveMs = obj["motionKeepAliveMs"].toDouble(2000.0);
+    return config;
+}
+
+void StreamConfig::writeJson(QJsonObject &obj) const
+{
+    obj["name"] = name;
+    obj["url"] = url;
+    obj["enabled"] = enabled;
+    if (detectWidth > 0) {
+        obj["detectWidth"] = detectWidth;
+    } else {
+        obj.remove("detectWidth");
+    }
+    obj["targetLatencyMs"] = targetLatencyMs;
+    obj["maxDetectInterval"] = maxDetectInterval;
+    if (replayFps != 0.0) {
+        obj["replayFps"] = replayFps;
+    } else {
+        obj.remove("replayFps");
+    }
+    if (replayLoops != 1) {
+        obj["replayLoops"] = replayLoops;
+    } else {
+        obj.remove("replayLoops");
+    }
+    if (reconnectAttempts != 0) {
+        obj["reconnectAttempts"] = reconnectAttempts;
+    } else {
+        obj.remove("reconnectAttempts");
+    }
+    if (reconnectMaxDelayMs != 30000) {
+        obj["reconnectMaxDelayMs"] = reconnectMaxDelayMs;
+    } else {
+        obj.remove("reconnectMaxDelayMs");
+    }
+    if (connectTimeoutMs != 5000) {
+        obj["connectTimeoutMs"] = connectTimeoutMs;
+    } else {
+        obj.remove("connectTimeoutMs");
+    }
+    if (queueSize != 1) {
+        obj["queueSize"] = queueSize;
+    } else {
+        obj.remove("queueSize");
+    }
+    if (dropPolicy != DropOldest) {
+        obj["dropPolicy"] = QString(dropPolicyNames[dropPolicy]);
+    } else {
+        obj.remove("dropPolicy");
+    }
+    if (maxFrameAgeMs > 0.0) {
+        obj["maxFrameAgeMs"] = maxFrameAgeMs;
+    } else {
+        obj.remove("maxFrameAgeMs");
+    }
+    if (motionThreshold != 0.002) {
+        obj["motionThreshold"] = motionThreshold;
+    } else {
+        obj.remove("motionThreshold");
+    }
+    if (motionKeepAliveMs != 2000.0) {
+        obj["motionKeepAliveMs"] = motionKeepAliveMs;
+    } else {
+        obj.remove("motionKeepAliveMs");
+    }
+}
+
+CaptureSource StreamConfig::captureSource() const
+{
+    CaptureSource source;
+    // At least one frame per detection interval survives a full queue
+    source.keyFrameInterval = maxDetectInterval;
+    // Besides the queue: the frame being decoded, the one being processed, the
+    // preview or tile mailbox, the one the GUI is drawing and a recorder job
+    source.frameBuffers = queueSize + 5;
+    if (deviceIndex >= 0) {
+        source.kind = CaptureSource::Webcam;
+        source.deviceIndex = deviceIndex;
+    } else if (url.contains("://")) {
+        source.kind = CaptureSource::Rtsp;
+        source.url = url;
+        source.reconnectAttempts = reconnectAttempts;
+        source.reconnectMaxDelayMs = reconnectMaxDelayMs;
+        source.connectTimeoutMs = connectTimeoutMs;
+    } else {
+        source.kind = CaptureSource::File;
+        source.url = url;
+        source.replayFps = replayFps;
+        source.replayLoops = replayLoops;
+    }
+    return source;
+}
@@ -0,0 +1,35 @@
+#ifndef STREAMCONFIG_H
+#define STREAMCONFIG_H
+
+#include <QString>
+#include <QJsonObject>
+#include "capturethread.h"
+
+// One entry of the "streams" array in streams.json
+struct StreamConfig
+{
+    QString name;
+    QString url;            // Network URL, or a local video file path
+    int deviceIndex = -1; // >= 0 selects a local camera instead of url
+    bool enabled = true;
+    int detectWidth = 0; // Width of the copy handed to detection, 0 = native resolution
+    double targetLatencyMs = 33.0; // Per-frame budget the detection cadence adapts to
+    int maxDetectInterval = 5;     // Upper bound on frames between full detections, 1 = every frame
+    double replayFps = 0.0;        // Video files: 0 = the file's own rate, < 0 = as fast as processed
+    int replayLoops = 1;           // Video files: times to play, 0 = forever
+    int reconnectAttempts = 0;     // Network streams: consecutive failures before giving up, 0 = never
+    int reconnectMaxDelayMs = 30000; // Network streams: cap on the backoff between attempts
+    int connectTimeoutMs = 5000;   // Network streams: open/read timeout
+    int queueSize = 1;             // Frames buffered between capture and detection
+    FrameDropPolicy dropPolicy = DropOldest; // What a full queue discards
+    double maxFrameAgeMs = 0.0;    // Frames older than this are skipped before detection, 0 = no deadline
+    double motionThreshold = 0.002; // Share of the motion thumbnail that must change to detect, 0 = always detect
+    double motionKeepAliveMs = 2000.0; // Detect at least this often even on a static scene
+
+    CaptureSource captureSource() const;
+
+    static StreamConfig fromJson(const QJsonObject &obj);
+    void writeJson(QJsonObject &obj) const;
+};
+
+#endif // STREAMCONFIG_H
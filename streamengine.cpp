@@ -0,0 +1,760 @@
+#include "streamengine.h"
+#include "detectionscheduler.h"
+#include "eventrecorder.h"
+#include "facegallery.h"
+#include "motiongate.h"
+#include "sightingslog.h"
+#include "trackembeddingcache.h"
+#include <QDebug>
+#include <QReadLocker>
+#include <QThread>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+// Full detections after start kept for the startup figures
+static const int kStartupSamples = 16;
+// A detection counts as steady within this factor of the median of the startup samples
+static const double kSteadyFactor = 1.5;
+
+struct StreamEngine::Stream
+{
+    StreamConfig config;
+    std::unique_ptr<FrameQueue> input;
+    int64_t maxFrameAgeNs = 0;
+    std::unique_ptr<CaptureThread> capture;
+    ModelSetPtr models;          // Worker only once running; session comes from its pool
+    unsigned modelsGeneration = 0;
+    std::atomic<const ModelSet *> modelsInUse{nullptr}; // For streamsAwaitingModels()
+    HFSession session = nullptr;
+    HFImageStream imageStream = nullptr; // Pointed at each detection image in turn
+    std::atomic<bool> busy{false};
+    bool live = true;
+    cv::Mat detectFrame; // Reused reduced copy for detection
+    DetectionScheduler scheduler;
+    MotionGate motion;
+    std::vector<FaceDetection> faces;
+    TrackEmbeddingCache embeddings;
+    std::vector<float> feature; // Scratch for feature extraction
+
+    // Scratch for the subset of faces handed to the optional stages
+    std::vector<int> stageFaces;
+    std::vector<HFaceRect> stageRects;
+    std::vector<HInt32> stageTrackIds;
+    std::vector<HFloat> stageConfidence;
+    std::vector<HFloat> stageAngles; // roll, yaw, pitch blocks
+    std::vector<HFFaceBasicToken> stageTokens;
+
+    PipelineMetrics metrics;
+    std::atomic<uint64_t> late{0}; // Frames skipped past their deadline
+
+    // Written by the worker holding the stream, published by startupCount
+    int64_t startedNs = 0;
+    int64_t startupDoneNs[kStartupSamples];
+    float startupDetectMs[kStartupSamples];
+    std::atomic<int> startupCount{0};
+
+    FrameMailbox tile;                     // Mosaic preview of this stream
+    std::atomic<int64_t> tileIntervalNs{-1};
+    int64_t nextTileNs = 0;                // Worker only
+};
+
+// Maps a detection-space rectangle back to source resolution
+static cv::Rect toSourceRect(const HFaceRect &rect, double scale)
+{
+    return cv::Rect(cvRound(rect.x * scale), cvRound(rect.y * scale),
+                    cvRound(rect.width * scale), cvRound(rect.height * scale));
+}
+
+StreamEngine::StreamEngine(QObject *parent)
+    : QObject(parent)
+    , modelsGeneration(0)
+    , matchThreshold(0.48f)
+    , embeddingRefreshMs(2000.0)
+    , embeddingQualityGain(0.1f)
+    , extractions(0)
+    , embeddingReuses(0)
+    , motionSkips(0)
+    , stagesForAll(0)
+    , stagesForMatched(0)
+    , recorder(nullptr)
+    , activeRecorder(nullptr)
+    , sightings(nullptr)
+    , activeSightings(nullptr)
+    , running(false)
+    , cursor(0)
+    , previewIndex(0)
+    , previewPaused(false)
+    , generation(0)
+    , wakeGeneration(0)
+{
+    connect(this, &StreamEngine::modelsRetired, this, &StreamEngine::releaseRetiredModels, Qt::QueuedConnection);
+}
+
+StreamEngine::~StreamEngine()
+{
+    stop();
+}
+
+bool StreamEngine::start(const QVector<StreamConfig> &configs, const ModelSetPtr &models,
+                         QString *errorMessage)
+{
+    if (isRunning() || configs.isEmpty() || !models) return false;
+
+    ++generation;
+    std::atomic_store(&latestModels, models);
+    const unsigned startGeneration = modelsGeneration.load(std::memory_order_relaxed);
+    extractions.store(0, std::memory_order_relaxed);
+    embeddingReuses.store(0, std::memory_order_relaxed);
+    motionSkips.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < configs.size(); ++i) {
+        std::unique_ptr<Stream> stream(new Stream);
+        stream->config = configs[i];
+        stream->scheduler = DetectionScheduler(stream->config.targetLatencyMs, stream->config.maxDetectInterval);
+        stream->embeddings = TrackEmbeddingCache(embeddingRefreshMs, embeddingQualityGain);
+        stream->motion = MotionGate(stream->config.motionThreshold, stream->config.motionKeepAliveMs);
+
+        // One session per stream for the whole run keeps track IDs continuous
+        stream->session = models->pool.acquire();
+        if (!stream->session) {
+            if (errorMessage) {
+                *errorMessage = QString("Session tidak cukup untuk %1 stream (pool berisi %2 session)")
+                                    .arg(configs.size()).arg(models->pool.size());
+            }
+            stop();
+            return false;
+        }
+        stream->models = models;
+        stream->modelsGeneration = startGeneration;
+        stream->modelsInUse.store(models.get(), std::memory_order_relaxed);
+
+        // Without a reusable image stream, detectFaces() creates one per frame
+        if (HFCreateImageStreamEmpty(&stream->imageStream) == HSUCCEED) {
+            HFImageStreamSetFormat(stream->imageStream, HF_STREAM_BGR);
+            HFImageStreamSetRotation(stream->imageStream, HF_CAMERA_ROTATION_0);
+        } else {
+            stream->imageStream = nullptr;
+        }
+
+        stream->input.reset(new FrameQueue(stream->config.queueSize, stream->config.dropPolicy));
+        stream->maxFrameAgeNs = int64_t(stream->config.maxFrameAgeMs * 1e6);
+        stream->startedNs = LatencyHistogram::nowNs();
+        stream->capture.reset(new CaptureThread(stream->config.captureSource(), stream->input.get()));
+        stream->capture->setDecodeHistogram(&stream->metrics.stages[StageDecode]);
+        stream->capture->setFrameCallback([this]() { notifyFrame(); });
+
+        // Signals arrive queued; drop the ones that belong to a previous run
+        const int runGeneration = generation;
+        connect(stream->capture.get(), &CaptureThread::openFailed, this,
+                [this, i, runGeneration](const QString &url) {
+            if (runGeneration != generation || i >= int(streams.size())) return;
+            streams[i]->live = false;
+            emit streamOpenFailed(i, url);
+        });
+        connect(stream->capture.get(), &CaptureThread::connectionLost, this,
+                [this, i, runGeneration](const QString &message) {
+            if (runGeneration != generation || i >= int(streams.size())) return;
+            streams[i]->live = false;
+            emit streamConnectionLost(i, message);
+        });
+        connect(stream->capture.get(), &CaptureThread::sourceEnded, this,
+                [this, i, runGeneration]() {
+            if (runGeneration != generation || i >= int(streams.size())) return;
+            streams[i]->live = false;
+            emit streamEnded(i);
+        });
+        connect(stream->capture.get(), &CaptureThread::stateChanged, this,
+                [this, i, runGeneration](int state, int attempt, int delayMs) {
+            if (runGeneration != generation || i >= int(streams.size())) return;
+            emit streamStateChanged(i, state, attempt, delayMs);
+        });
+        streams.push_back(std::move(stream));
+    }
+
+    QStringList names;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        names.append(stream->config.name.isEmpty() ? stream->config.url : stream->config.name);
+    }
+    if (recorder && recorder->enabled()) {
+        recorder->start(names);
+        activeRecorder = recorder;
+    }
+    if (sightings && sightings->enabled()) {
+        sightings->start(names);
+        activeSightings = sightings;
+    }
+
+    // More workers than streams would only contend for the same busy flags
+    const int workerTotal = std::min(std::max(1, QThread::idealThreadCount()), int(streams.size()));
+    running.store(true, std::memory_order_release);
+    for (int i = 0; i < workerTotal; ++i) {
+        workers.emplace_back(&StreamEngine::workerLoop, this);
+    }
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        stream->capture->start();
+    }
+
+    qDebug() << "Memulai" << streams.size() << "stream dengan" << workerTotal << "worker thread";
+    return true;
+}
+
+void StreamEngine::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false, std::memory_order_release);
+    }
+    wakeCondition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // Workers are gone, so nothing new reaches the recorder; flush open events
+    if (activeRecorder) {
+        activeRecorder->stop();
+        activeRecorder = nullptr;
+    }
+    if (activeSightings) {
+        activeSightings->stop();
+        activeSightings = nullptr;
+    }
+
+    // Interrupt every capture first so slow sources shut down in parallel
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        if (stream->capture) stream->capture->requestInterruption();
+    }
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        if (stream->capture) stream->capture->stop();
+        if (stream->session) stream->models->pool.giveBack(stream->session);
+        if (stream->imageStream) HFReleaseImageStream(stream->imageStream);
+    }
+    streams.clear();
+    previewMailbox.clear();
+    std::atomic_store(&latestModels, ModelSetPtr());
+    releaseRetiredModels();
+}
+
+void StreamEngine::releaseRetiredModels()
+{
+    std::vector<ModelSetPtr> retired;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retired.swap(retiredModels);
+    }
+    // The last stream to leave a set drops it here, outside the lock
+}
+
+void StreamEngine::setModels(const ModelSetPtr &models)
+{
+    if (!models || !isRunning()) return;
+    std::atomic_store(&latestModels, models);
+    modelsGeneration.fetch_add(1, std::memory_order_release);
+}
+
+int StreamEngine::streamsAwaitingModels() const
+{
+    const ModelSetPtr latest = std::atomic_load(&latestModels);
+    int count = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        if (stream->modelsInUse.load(std::memory_order_relaxed) != latest.get()) ++count;
+    }
+    return count;
+}
+
+void StreamEngine::switchModels(Stream &stream)
+{
+    const unsigned latestGeneration = modelsGeneration.load(std::memory_order_acquire);
+    if (latestGeneration == stream.modelsGeneration) return;
+
+    ModelSetPtr latest = std::atomic_load(&latestModels);
+    if (latest == stream.models) {
+        stream.modelsGeneration = latestGeneration;
+        return;
+    }
+    // Every new session is taken for now; try again on the next frame
+    HFSession session = latest->pool.acquire();
+    if (!session) return;
+
+    stream.models->pool.giveBack(stream.session);
+    stream.session = session;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retiredModels.push_back(std::move(stream.models));
+    }
+    emit modelsRetired();
+    stream.models = std::move(latest);
+    stream.modelsGeneration = latestGeneration;
+    stream.modelsInUse.store(stream.models.get(), std::memory_order_relaxed);
+
+    // Track IDs, embeddings and matches all belong to the old sessions and gallery
+    stream.faces.clear();
+    stream.embeddings.clear();
+    stream.scheduler.reset();
+}
+
+int StreamEngine::liveStreamCount() const
+{
+    int count = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        if (stream->live) ++count;
+    }
+    return count;
+}
+
+std::vector<PipelineMetricsSnapshot> StreamEngine::metricsSnapshot() const
+{
+    std::vector<PipelineMetricsSnapshot> snapshots(streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        const Stream &stream = *streams[i];
+        snapshots[i].stream = stream.config.name.isEmpty() ? stream.config.url : stream.config.name;
+        for (int stage = 0; stage < StageCount; ++stage) {
+            snapshots[i].stages[stage] = stream.metrics.stages[stage].snapshot();
+        }
+        snapshots[i].droppedFrames = stream.input->droppedFrames();
+        snapshots[i].lateFrames = stream.late.load(std::memory_order_relaxed);
+
+        // Startup: when the first detection no slower than kSteadyFactor x the median finished
+        const int count = stream.startupCount.load(std::memory_order_acquire);
+        if (count > 0) {
+            std::vector<float> detectMs(stream.startupDetectMs, stream.startupDetectMs + count);
+            std::nth_element(detectMs.begin(), detectMs.begin() + count / 2, detectMs.end());
+            const double median = detectMs[count / 2];
+            snapshots[i].firstDetectMs = stream.startupDetectMs[0];
+            snapshots[i].steadyDetectMs = median;
+            for (int sample = 0; sample < count; ++sample) {
+                if (stream.startupDetectMs[sample] <= kSteadyFactor * median) {
+                    snapshots[i].startupMs = (stream.startupDoneNs[sample] - stream.startedNs) / 1e6;
+                    break;
+                }
+            }
+        }
+    }
+    return snapshots;
+}
+
+uint64_t StreamEngine::droppedFrames() const
+{
+    uint64_t total = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        total += stream->input->droppedFrames();
+    }
+    return total;
+}
+
+uint64_t StreamEngine::lateFrames() const
+{
+    uint64_t total = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        total += stream->late.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t StreamEngine::frameBufferAllocations() const
+{
+    uint64_t total = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        total += stream->capture->framePool().allocations();
+    }
+    return total;
+}
+
+uint64_t StreamEngine::frameBufferReuses() const
+{
+    uint64_t total = 0;
+    for (const std::unique_ptr<Stream> &stream : streams) {
+        total += stream->capture->framePool().reuses();
+    }
+    return total;
+}
+
+void StreamEngine::setEmbeddingCachePolicy(double refreshMs, float qualityGain)
+{
+    embeddingRefreshMs = refreshMs;
+    embeddingQualityGain = qualityGain;
+}
+
+void StreamEngine::setStageDemand(unsigned allFaces, unsigned matchedFaces)
+{
+    stagesForAll.store(allFaces, std::memory_order_relaxed);
+    stagesForMatched.store(matchedFaces, std::memory_order_relaxed);
+}
+
+void StreamEngine::setResultCallback(ResultCallback callback)
+{
+    resultCallback = std::move(callback);
+}
+
+void StreamEngine::setPreviewStream(int index)
+{
+    previewIndex.store(index, std::memory_order_relaxed);
+    previewMailbox.clear();
+}
+
+void StreamEngine::setTileInterval(int index, int64_t intervalNs)
+{
+    if (index < 0 || index >= int(streams.size())) return;
+    streams[index]->tileIntervalNs.store(intervalNs, std::memory_order_relaxed);
+    if (intervalNs < 0) streams[index]->tile.clear();
+}
+
+FramePtr StreamEngine::takeTileFrame(int index)
+{
+    if (index < 0 || index >= int(streams.size())) return nullptr;
+    return streams[index]->tile.take();
+}
+
+void StreamEngine::notifyFrame()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++wakeGeneration;
+    }
+    wakeCondition.notify_one();
+}
+
+void StreamEngine::workerLoop()
+{
+    while (running.load(std::memory_order_acquire)) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            seen = wakeGeneration;
+        }
+
+        if (processAvailable()) continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this, seen]() {
+            return wakeGeneration != seen || !running.load(std::memory_order_relaxed);
+        });
+    }
+}
+
+bool StreamEngine::processAvailable()
+{
+    // Each pass starts at a different stream so no camera is starved
+    const size_t count = streams.size();
+    const size_t first = cursor.fetch_add(1, std::memory_order_relaxed);
+    bool processed = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = (first + i) % count;
+        Stream &stream = *streams[index];
+        if (stream.busy.exchange(true, std::memory_order_acquire)) continue;
+
+        FramePtr frame = takeFresh(stream);
+        if (frame) {
+            processFrame(stream, int(index), std::move(frame));
+            processed = true;
+        }
+        stream.busy.store(false, std::memory_order_release);
+    }
+    return processed;
+}
+
+FramePtr StreamEngine::takeFresh(Stream &stream)
+{
+    // Skip frames that already missed their deadline instead of detecting on stale video
+    FramePtr frame = stream.input->take();
+    if (stream.maxFrameAgeNs <= 0) return frame;
+
+    const int64_t now = LatencyHistogram::nowNs();
+    while (frame && now - frame->captureTimeNs > stream.maxFrameAgeNs) {
+        stream.late.fetch_add(1, std::memory_order_relaxed);
+        frame = stream.input->take();
+    }
+    return frame;
+}
+
+bool StreamEngine::detectFaces(Stream &stream, const cv::Mat &frame, int64_t timeNs)
+{
+    // Detect on a reduced copy when the stream asks for it; the full frame stays
+    // untouched for anything that needs source resolution
+    PipelineMetrics &metrics = stream.metrics;
+    const int64_t started = LatencyHistogram::nowNs();
+    cv::Mat detectImage = frame;
+    double scale = 1.0;
+    const int detectWidth = stream.config.detectWidth;
+    if (detectWidth > 0 && frame.cols > detectWidth) {
+        scale = double(frame.cols) / detectWidth;
+        cv::resize(frame, stream.detectFrame, cv::Size(detectWidth, cvRound(frame.rows / scale)),
+                   0, 0, cv::INTER_AREA);
+        detectImage = stream.detectFrame;
+    }
+
+    // A model reload waits until no frame is inside the SDK
+    QReadLocker sdkLocker(&inspireFaceLock());
+
+    // Point the stream's image stream at the frame; it only wraps the pixels, so nothing is copied
+    HFImageStream streamHandle = stream.imageStream;
+    HResult ret;
+    if (streamHandle) {
+        InspireFaceCall call;
+        ret = HFImageStreamSetBuffer(streamHandle, detectImage.data, detectImage.cols, detectImage.rows);
+    } else {
+        HFImageData imageData;
+        imageData.data = detectImage.data;
+        imageData.width = detectImage.cols;
+        imageData.height = detectImage.rows;
+        imageData.format = HF_STREAM_BGR;
+        imageData.rotation = HF_CAMERA_ROTATION_0;
+        InspireFaceCall call;
+        ret = HFCreateImageStream(&imageData, &streamHandle);
+    }
+    if (ret != HSUCCEED) {
+        qDebug() << "Error: Gagal membuat image stream";
+        return false;
+    }
+    const int64_t streamCreated = LatencyHistogram::nowNs();
+    metrics.stages[StageImageStream].record(streamCreated - started);
+
+    // Detect faces
+    HFMultipleFaceData results;
+    {
+        InspireFaceCall call;
+        ret = HFExecuteFaceTrack(stream.session, streamHandle, &results);
+    }
+    const int64_t tracked = LatencyHistogram::nowNs();
+    metrics.stages[StageTrack].record(tracked - streamCreated);
+    if (ret == HSUCCEED) {
+        stream.faces.resize(results.detectedNum);
+        for (int i = 0; i < results.detectedNum; i++) {
+            FaceDetection &face = stream.faces[i];
+            face.trackId = results.trackIds[i];
+            face.rect = toSourceRect(results.rects[i], scale);
+            face.confidence = results.detConfidence[i];
+            face.hasAngles = results.angles.yaw && results.angles.pitch && results.angles.roll;
+            if (face.hasAngles) {
+                face.yaw = results.angles.yaw[i];
+                face.pitch = results.angles.pitch[i];
+                face.roll = results.angles.roll[i];
+            }
+            face.predicted = false;
+            face.quality = -1.0f;
+            face.identity = -1;
+            face.matchScore = 0.0f;
+        }
+        identifyFaces(stream, streamHandle, results, timeNs);
+        analyseFaces(stream, streamHandle, results);
+        stream.embeddings.retain(stream.faces);
+        metrics.stages[StageRecognition].record(LatencyHistogram::nowNs() - tracked);
+    }
+
+    if (streamHandle != stream.imageStream) {
+        InspireFaceCall call;
+        HFReleaseImageStream(streamHandle);
+    }
+    return ret == HSUCCEED;
+}
+
+void StreamEngine::identifyFaces(Stream &stream, HFImageStream streamHandle,
+                                 const HFMultipleFaceData &results, int64_t timeNs)
+{
+    const FaceGallery &gallery = stream.models->gallery;
+    if (gallery.size() == 0) return;
+
+    // Tokens refer to the detection image stream, so extraction has to happen here
+    stream.feature.resize(gallery.dimension());
+    for (int i = 0; i < results.detectedNum; i++) {
+        FaceDetection &face = stream.faces[i];
+        HFloat quality = 0.0f;
+        HResult ret;
+        {
+            InspireFaceCall call;
+            ret = HFFaceQualityDetect(stream.session, results.tokens[i], &quality);
+        }
+        if (ret == HSUCCEED) face.quality = quality;
+
+        // A track that already has a good enough embedding keeps its identity
+        if (!stream.embeddings.needsExtraction(face.trackId, face.quality, timeNs)) {
+            if (stream.embeddings.apply(face) && face.identity >= 0) face.name = gallery.name(face.identity);
+            embeddingReuses.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        {
+            InspireFaceCall call;
+            ret = HFFaceFeatureExtractCpy(stream.session, streamHandle, results.tokens[i], stream.feature.data());
+        }
+        if (ret != HSUCCEED) continue;
+        extractions.fetch_add(1, std::memory_order_relaxed);
+
+        GalleryMatch match;
+        if (gallery.search(stream.feature.data(), int(stream.feature.size()), 1, &match) == 1
+            && match.score >= matchThreshold.load(std::memory_order_relaxed)) {
+            face.identity = match.identity;
+            face.matchScore = match.score;
+            face.name = gallery.name(match.identity);
+        }
+        stream.embeddings.store(face.trackId, face.quality, stream.feature.data(), int(stream.feature.size()),
+                                face.identity, face.matchScore, timeNs);
+    }
+}
+
+void StreamEngine::analyseFaces(Stream &stream, HFImageStream streamHandle, const HFMultipleFaceData &results)
+{
+    const unsigned forAll = stagesForAll.load(std::memory_order_relaxed);
+    const unsigned forMatched = stagesForMatched.load(std::memory_order_relaxed);
+
+    // Only faces missing a stage somebody asked for go through the pipeline;
+    // everything else reuses what its track already has
+    unsigned stages = 0;
+    stream.stageFaces.clear();
+    for (int i = 0; i < results.detectedNum; i++) {
+        FaceDetection &face = stream.faces[i];
+        stream.embeddings.applyAnalysis(face);
+        const unsigned wanted = forAll | (face.identity >= 0 ? forMatched : 0u);
+        const unsigned missing = wanted & ~face.analysis.stages;
+        if (missing) {
+            stream.stageFaces.push_back(i);
+            stages |= missing;
+        }
+    }
+    if (stream.stageFaces.empty()) return;
+
+    const int count = int(stream.stageFaces.size());
+    const bool hasAngles = results.angles.roll && results.angles.yaw && results.angles.pitch;
+    stream.stageRects.resize(count);
+    stream.stageTrackIds.resize(count);
+    stream.stageConfidence.resize(count);
+    stream.stageAngles.resize(hasAngles ? 3 * count : 0);
+    stream.stageTokens.resize(count);
+    for (int j = 0; j < count; ++j) {
+        const int i = stream.stageFaces[j];
+        stream.stageRects[j] = results.rects[i];
+        stream.stageTrackIds[j] = results.trackIds[i];
+        stream.stageConfidence[j] = results.detConfidence[i];
+        stream.stageTokens[j] = results.tokens[i];
+        if (hasAngles) {
+            stream.stageAngles[j] = results.angles.roll[i];
+            stream.stageAngles[count + j] = results.angles.yaw[i];
+            stream.stageAngles[2 * count + j] = results.angles.pitch[i];
+        }
+    }
+
+    HFMultipleFaceData subset = results;
+    subset.detectedNum = count;
+    subset.rects = stream.stageRects.data();
+    subset.trackIds = stream.stageTrackIds.data();
+    subset.detConfidence = stream.stageConfidence.data();
+    subset.tokens = stream.stageTokens.data();
+    subset.angles.roll = hasAngles ? stream.stageAngles.data() : nullptr;
+    subset.angles.yaw = hasAngles ? stream.stageAngles.data() + count : nullptr;
+    subset.angles.pitch = hasAngles ? stream.stageAngles.data() + 2 * count : nullptr;
+
+    HFRGBLivenessConfidence liveness = {};
+    HFFaceMaskConfidence mask = {};
+    HFFaceAttributeResult attributes = {};
+    {
+        InspireFaceCall call;
+        if (HFMultipleFacePipelineProcessOptional(stream.session, streamHandle, &subset,
+                                                  pipelineOption(stages)) != HSUCCEED) {
+            return;
+        }
+        if ((stages & FaceStageLiveness) && HFGetRGBLivenessConfidence(stream.session, &liveness) != HSUCCEED) {
+            stages &= ~unsigned(FaceStageLiveness);
+        }
+        if ((stages & FaceStageMask) && HFGetFaceMaskConfidence(stream.session, &mask) != HSUCCEED) {
+            stages &= ~unsigned(FaceStageMask);
+        }
+        if ((stages & FaceStageAttribute) && HFGetFaceAttributeResult(stream.session, &attributes) != HSUCCEED) {
+            stages &= ~unsigned(FaceStageAttribute);
+        }
+    }
+
+    for (int j = 0; j < count; ++j) {
+        FaceDetection &face = stream.faces[stream.stageFaces[j]];
+        if ((stages & FaceStageLiveness) && j < liveness.num) {
+            face.analysis.liveness = liveness.confidence[j];
+            face.analysis.stages |= FaceStageLiveness;
+        }
+        if ((stages & FaceStageMask) && j < mask.num) {
+            face.analysis.mask = mask.confidence[j];
+            face.analysis.stages |= FaceStageMask;
+        }
+        if ((stages & FaceStageAttribute) && j < attributes.num) {
+            face.analysis.race = attributes.race[j];
+            face.analysis.gender = attributes.gender[j];
+            face.analysis.ageBracket = attributes.ageBracket[j];
+            face.analysis.stages |= FaceStageAttribute;
+        }
+        stream.embeddings.storeAnalysis(face.trackId, face.analysis);
+    }
+}
+
+void StreamEngine::processFrame(Stream &stream, int index, FramePtr captured)
+{
+    cv::Mat &frame = captured->image;
+    PipelineMetrics &metrics = stream.metrics;
+    const int64_t started = LatencyHistogram::nowNs();
+    metrics.stages[StageQueue].record(started - captured->captureTimeNs);
+    switchModels(stream);
+
+    // The background model follows every frame so it is current once tracks end
+    bool moving = true;
+    if (stream.motion.enabled()) {
+        moving = stream.motion.update(frame, started);
+        metrics.stages[StageMotion].record(LatencyHistogram::nowNs() - started);
+    }
+
+    // Full detection only when the scheduler asks for it; otherwise extrapolate the last boxes.
+    // A static scene with nothing tracked skips inference until something moves.
+    bool detected = stream.scheduler.detectDue();
+    if (detected && !moving && stream.faces.empty()) {
+        detected = false;
+        motionSkips.fetch_add(1, std::memory_order_relaxed);
+    } else if (detected) {
+        const int64_t detectStarted = LatencyHistogram::nowNs();
+        if (!detectFaces(stream, frame, captured->captureTimeNs)) return;
+        const int64_t detectFinished = LatencyHistogram::nowNs();
+        stream.scheduler.onDetected(stream.faces, frame.size(), (detectFinished - detectStarted) / 1e6);
+        const int startupCount = stream.startupCount.load(std::memory_order_relaxed);
+        if (startupCount < kStartupSamples) {
+            stream.startupDoneNs[startupCount] = detectFinished;
+            stream.startupDetectMs[startupCount] = float((detectFinished - detectStarted) / 1e6);
+            stream.startupCount.store(startupCount + 1, std::memory_order_release);
+        }
+        stream.motion.onDetected(detectStarted);
+    } else {
+        const int64_t predictStarted = LatencyHistogram::nowNs();
+        stream.scheduler.predict(stream.faces, frame.size());
+        const int64_t predictNs = LatencyHistogram::nowNs() - predictStarted;
+        metrics.stages[StagePredict].record(predictNs);
+        stream.scheduler.onPredicted(predictNs / 1e6);
+    }
+
+    if (resultCallback) {
+        resultCallback(index, *captured, stream.faces, detected);
+    }
+    if (activeRecorder) {
+        activeRecorder->onFrame(index, *captured, stream.faces);
+    }
+    if (activeSightings) {
+        activeSightings->onFrame(index, captured->captureTimeNs, stream.faces,
+                                 activeRecorder ? activeRecorder->openEventMs(index) : 0);
+    }
+
+    const bool preview = !previewPaused.load(std::memory_order_relaxed)
+                         && index == previewIndex.load(std::memory_order_relaxed);
+    // Small or hidden tiles are throttled here, before anything is copied for the GUI
+    const int64_t tileIntervalNs = stream.tileIntervalNs.load(std::memory_order_relaxed);
+    const bool tile = !preview && tileIntervalNs >= 0 && captured->captureTimeNs >= stream.nextTileNs;
+    if (preview || tile) {
+        // Boxes are drawn by the GUI after scaling; the frame itself stays untouched
+        const int64_t overlayStarted = LatencyHistogram::nowNs();
+        // Pooled frames keep the capacity of faces, so this copy does not allocate once warm
+        captured->faces.assign(stream.faces.begin(), stream.faces.end());
+        const int64_t finished = LatencyHistogram::nowNs();
+        metrics.stages[StageOverlay].record(finished - overlayStarted);
+        metrics.stages[StageTotal].record(finished - captured->captureTimeNs);
+        if (preview) {
+            previewMailbox.publish(std::move(captured));
+        } else {
+            stream.nextTileNs = captured->captureTimeNs + tileIntervalNs;
+            stream.tile.publish(std::move(captured));
+        }
+    } else {
+        metrics.stages[StageTotal].record(LatencyHistogram::nowNs() - captured->captureTimeNs);
+    }
+}
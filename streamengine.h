@@ -0,0 +1,163 @@
+#ifndef STREAMENGINE_H
+#define STREAMENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <inspireface.h>
+#include "capturethread.h"
+#include "facedetection.h"
+#include "framemailbox.h"
+#include "framequeue.h"
+#include "modelset.h"
+#include "pipelinemetrics.h"
+#include "streamconfig.h"
+
+class EventRecorder;
+class SightingsLog;
+
+// Runs any number of capture sources at once. Every source gets its own
+// CaptureThread and a tracking session leased from the pool of a ModelSet; detection is scheduled over a fixed
+// pool of worker threads, and a stream is only ever processed by one worker
+// at a time so its tracking state stays consistent.
+class StreamEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Runs on a worker thread after every processed frame; detected is false
+    // when the boxes were extrapolated instead of measured. Calls for one
+    // stream never overlap, calls for different streams may.
+    typedef std::function<void(int index, const CapturedFrame &frame,
+                               const std::vector<FaceDetection> &faces, bool detected)> ResultCallback;
+
+    explicit StreamEngine(QObject *parent = nullptr);
+    ~StreamEngine();
+
+    bool start(const QVector<StreamConfig> &configs, const ModelSetPtr &models,
+               QString *errorMessage = nullptr);
+    void stop();
+
+    bool isRunning() const { return !streams.empty(); }
+    int streamCount() const { return int(streams.size()); }
+    int liveStreamCount() const;
+    int workerCount() const { return int(workers.size()); }
+    // Per-stage latency histograms of every running stream; cheap enough to poll every second
+    std::vector<PipelineMetricsSnapshot> metricsSnapshot() const;
+
+    // Frames a full input queue discarded under its drop policy, over all streams
+    uint64_t droppedFrames() const;
+    // Frames skipped because they exceeded their stream's maxFrameAgeMs, over all streams
+    uint64_t lateFrames() const;
+    // Decoded frames that needed a fresh buffer and ones that reused a FramePool buffer, over all streams
+    uint64_t frameBufferAllocations() const;
+    uint64_t frameBufferReuses() const;
+
+    // Switches running streams to models without stopping them. Each stream
+    // moves at its next frame boundary, as soon as a session of the new set is
+    // free, and starts tracking afresh; the previous set is released by the
+    // last stream to leave it.
+    void setModels(const ModelSetPtr &models);
+    // Streams still on a set other than the one last given to setModels()
+    int streamsAwaitingModels() const;
+
+    // Faces are identified against their ModelSet's gallery when it is not empty. Safe while running.
+    void setMatchThreshold(float threshold) { matchThreshold.store(threshold, std::memory_order_relaxed); }
+    // When a tracked face is extracted again; applies to streams started afterwards
+    void setEmbeddingCachePolicy(double refreshMs, float qualityGain);
+
+    // FaceStage flags to run once per track, for every face or only for faces
+    // matched against the gallery. The sessions must have been created with
+    // those stages enabled (see sessionParameter()).
+    void setStageDemand(unsigned allFaces, unsigned matchedFaces);
+
+    // Feature extractions run vs. skipped thanks to the per-track cache, for the current run
+    uint64_t featureExtractions() const { return extractions.load(std::memory_order_relaxed); }
+    uint64_t reusedEmbeddings() const { return embeddingReuses.load(std::memory_order_relaxed); }
+    // Due detections skipped because the scene was static and nothing was tracked
+    uint64_t motionSkippedFrames() const { return motionSkips.load(std::memory_order_relaxed); }
+
+    // Set while stopped; the GUI leaves it empty
+    void setResultCallback(ResultCallback callback);
+    // Set while stopped; started and stopped with the streams when it is enabled
+    void setRecorder(EventRecorder *eventRecorder) { recorder = eventRecorder; }
+    // Same for the sightings log; every frame of every stream is reported to it
+    void setSightingsLog(SightingsLog *log) { sightings = log; }
+
+    // Only the preview stream is handed to the UI, with its detections attached
+    void setPreviewStream(int index);
+    void setPreviewPaused(bool paused) { previewPaused.store(paused, std::memory_order_relaxed); }
+    FramePtr takePreviewFrame() { return previewMailbox.take(); }
+
+    // Mosaic preview: each stream hands frames with detections to its own
+    // tile, at most one per intervalNs of capture time. A negative interval
+    // (the default) means the stream has no visible tile.
+    void setTileInterval(int index, int64_t intervalNs);
+    FramePtr takeTileFrame(int index);
+
+signals:
+    void streamOpenFailed(int index, const QString &url);
+    void streamConnectionLost(int index, const QString &message);
+    void streamEnded(int index); // A video file played to the end
+    void streamStateChanged(int index, int state, int attempt, int delayMs); // CaptureThread::State
+    void modelsRetired(); // Internal: a worker left a ModelSet behind
+
+private slots:
+    void releaseRetiredModels();
+
+private:
+    struct Stream;
+
+    void workerLoop();
+    bool processAvailable();
+    FramePtr takeFresh(Stream &stream);
+    bool detectFaces(Stream &stream, const cv::Mat &frame, int64_t timeNs);
+    void identifyFaces(Stream &stream, HFImageStream streamHandle, const HFMultipleFaceData &results,
+                       int64_t timeNs);
+    void analyseFaces(Stream &stream, HFImageStream streamHandle, const HFMultipleFaceData &results);
+    void processFrame(Stream &stream, int index, FramePtr frame);
+    void switchModels(Stream &stream);
+    void notifyFrame();
+
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<std::thread> workers;
+    // Read with std::atomic_load only when modelsGeneration has moved
+    ModelSetPtr latestModels;
+    std::atomic<unsigned> modelsGeneration;
+    // Sets the workers switched away from. They are released on the engine's
+    // thread, so freeing sessions and a gallery never stalls a frame.
+    std::mutex retiredMutex;
+    std::vector<ModelSetPtr> retiredModels;
+    std::atomic<float> matchThreshold;
+    double embeddingRefreshMs;
+    float embeddingQualityGain;
+    std::atomic<uint64_t> extractions;
+    std::atomic<uint64_t> embeddingReuses;
+    std::atomic<uint64_t> motionSkips;
+    std::atomic<unsigned> stagesForAll;
+    std::atomic<unsigned> stagesForMatched;
+    ResultCallback resultCallback;
+    EventRecorder *recorder;
+    EventRecorder *activeRecorder; // recorder while it runs, else null
+    SightingsLog *sightings;
+    SightingsLog *activeSightings;
+    std::atomic<bool> running;
+    std::atomic<unsigned> cursor;
+    std::atomic<int> previewIndex;
+    std::atomic<bool> previewPaused;
+    FrameMailbox previewMailbox;
+    int generation;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    uint64_t wakeGeneration;
+};
+
+#endif // STREAMENGINE_H
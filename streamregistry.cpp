@@ -0,0 +1,64 @@
+#include "streamregistry.h"
+
+StreamRegistry::StreamRegistry()
+    : nextId(1)
+{
+}
+
+void StreamRegistry::load(const QJsonArray &streams)
+{
+    entries.clear();
+    rowById.clear();
+    entries.reserve(streams.size());
+    rowById.reserve(streams.size());
+    for (const QJsonValue &value : streams) {
+        Entry entry;
+        entry.id = nextId++;
+        entry.json = value.toObject();
+        entry.config = StreamConfig::fromJson(entry.json);
+        rowById.insert(entry.id, entries.size());
+        entries.append(entry);
+    }
+}
+
+QJsonArray StreamRegistry::toJson() const
+{
+    // Every object is implicitly shared, so this copies no stream settings
+    QJsonArray streams;
+    for (const Entry &entry : entries) {
+        streams.append(entry.json);
+    }
+    return streams;
+}
+
+int StreamRegistry::append(const StreamConfig &config)
+{
+    Entry entry;
+    entry.id = nextId++;
+    entry.config = config;
+    config.writeJson(entry.json);
+    rowById.insert(entry.id, entries.size());
+    entries.append(entry);
+    return entry.id;
+}
+
+void StreamRegistry::remove(int row)
+{
+    rowById.remove(entries[row].id);
+    entries.remove(row);
+    reindexFrom(row);
+}
+
+void StreamRegistry::update(int row, const StreamConfig &config)
+{
+    Entry &entry = entries[row];
+    entry.config = config;
+    config.writeJson(entry.json);
+}
+
+void StreamRegistry::reindexFrom(int row)
+{
+    for (int i = row; i < entries.size(); ++i) {
+        rowById[entries[i].id] = i;
+    }
+}
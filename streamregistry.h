@@ -0,0 +1,49 @@
+#ifndef STREAMREGISTRY_H
+#define STREAMREGISTRY_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include "streamconfig.h"
+
+// The "streams" array of streams.json held as rows with stable IDs. Each row
+// keeps its JSON object verbatim, so keys this build does not know survive a
+// save, next to the parsed StreamConfig the engine runs from. IDs are handed
+// out at load and never reused, so anything that must outlive row removal
+// (running streams, status text) holds an ID and looks the row up in O(1).
+class StreamRegistry
+{
+public:
+    StreamRegistry();
+
+    void load(const QJsonArray &streams);
+    QJsonArray toJson() const;
+
+    int count() const { return entries.size(); }
+    int id(int row) const { return entries[row].id; }
+    int row(int id) const { return rowById.value(id, -1); } // -1 when removed
+    const StreamConfig &config(int row) const { return entries[row].config; }
+
+    // Returns the ID of the new row, which is appended at the end
+    int append(const StreamConfig &config);
+    void remove(int row);
+    void update(int row, const StreamConfig &config);
+
+private:
+    struct Entry
+    {
+        int id;
+        QJsonObject json;
+        StreamConfig config;
+    };
+
+    void reindexFrom(int row);
+
+    QVector<Entry> entries;
+    QHash<int, int> rowById;
+    int nextId;
+};
+
+#endif // STREAMREGISTRY_H
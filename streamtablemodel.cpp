@@ -0,0 +1,134 @@
+#include "streamtablemodel.h"
+
+StreamTableModel::StreamTableModel(StreamRegistry *registry, QObject *parent)
+    : QAbstractTableModel(parent)
+    , registry(registry)
+{
+}
+
+int StreamTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : registry->count();
+}
+
+int StreamTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant StreamTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= registry->count()) return QVariant();
+
+    const StreamConfig &config = registry->config(index.row());
+    switch (index.column()) {
+    case NameColumn:
+        if (role == Qt::DisplayRole || role == Qt::EditRole) return config.name;
+        if (role == Qt::CheckStateRole) return config.enabled ? Qt::Checked : Qt::Unchecked;
+        break;
+    case UrlColumn:
+        if (role == Qt::DisplayRole || role == Qt::EditRole) return config.url;
+        break;
+    case StatusColumn:
+        if (role == Qt::DisplayRole) return statuses.value(registry->id(index.row()));
+        break;
+    }
+    return QVariant();
+}
+
+bool StreamTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= registry->count()) return false;
+
+    StreamConfig config = registry->config(index.row());
+    if (index.column() == NameColumn && role == Qt::CheckStateRole) {
+        // Checked streams are the ones a multi-stream run starts
+        config.enabled = value.toInt() == Qt::Checked;
+    } else if (index.column() == NameColumn && role == Qt::EditRole) {
+        config.name = value.toString();
+    } else if (index.column() == UrlColumn && role == Qt::EditRole) {
+        config.url = value.toString();
+    } else {
+        return false;
+    }
+
+    registry->update(index.row(), config);
+    emit dataChanged(index, index);
+    emit streamsChanged();
+    return true;
+}
+
+Qt::ItemFlags StreamTableModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+    if (index.column() == NameColumn) flags |= Qt::ItemIsEditable | Qt::ItemIsUserCheckable;
+    if (index.column() == UrlColumn) flags |= Qt::ItemIsEditable;
+    return flags;
+}
+
+QVariant StreamTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section + 1;
+
+    switch (section) {
+    case NameColumn: return QString("Name");
+    case UrlColumn: return QString("URL");
+    case StatusColumn: return QString("Status");
+    }
+    return QVariant();
+}
+
+void StreamTableModel::reload()
+{
+    beginResetModel();
+    statuses.clear();
+    endResetModel();
+}
+
+void StreamTableModel::addStream(const StreamConfig &config)
+{
+    const int row = registry->count();
+    beginInsertRows(QModelIndex(), row, row);
+    registry->append(config);
+    endInsertRows();
+    emit streamsChanged();
+}
+
+void StreamTableModel::removeStream(int row)
+{
+    if (row < 0 || row >= registry->count()) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    statuses.remove(registry->id(row));
+    registry->remove(row);
+    endRemoveRows();
+    emit streamsChanged();
+}
+
+void StreamTableModel::setStatus(int id, const QString &status)
+{
+    if (status.isEmpty()) {
+        statuses.remove(id);
+    } else {
+        statuses.insert(id, status);
+    }
+
+    const int row = registry->row(id);
+    if (row < 0) return;
+    const QModelIndex cell = index(row, StatusColumn);
+    emit dataChanged(cell, cell);
+}
+
+void StreamTableModel::clearStatuses()
+{
+    // Only rows that showed something need repainting
+    const QList<int> ids = statuses.keys();
+    statuses.clear();
+    for (int id : ids) {
+        const int row = registry->row(id);
+        if (row < 0) continue;
+        const QModelIndex cell = index(row, StatusColumn);
+        emit dataChanged(cell, cell);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef STREAMTABLEMODEL_H
+#define STREAMTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include "streamregistry.h"
+
+// Stream Management table over a StreamRegistry: name (checkbox = enabled),
+// URL and connection status. The view only asks for the rows it shows, and
+// every change is reported for the cell it touched, so thousands of streams
+// cost no more to edit than a handful.
+class StreamTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, UrlColumn, StatusColumn, ColumnCount };
+
+    explicit StreamTableModel(StreamRegistry *registry, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Call after replacing the registry contents wholesale
+    void reload();
+    void addStream(const StreamConfig &config);
+    void removeStream(int row);
+
+    // Runtime state of a running stream; empty clears it
+    void setStatus(int id, const QString &status);
+    void clearStatuses();
+
+signals:
+    // A stream was added, removed or edited and streams.json is out of date
+    void streamsChanged();
+
+private:
+    StreamRegistry *registry;
+    QHash<int, QString> statuses; // Stream ID -> status text
+};
+
+#endif // STREAMTABLEMODEL_H
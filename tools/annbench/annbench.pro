@@ -0,0 +1,24 @@
+# Recall and throughput of the gallery indexes against brute force on synthetic embeddings
+QT += core
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = annbench
+
+INCLUDEPATH += $$PWD/../..
+
+HEADERS += \
+    ../../facegallery.h \
+    ../../galleryindex.h \
+    ../../hnswindex.h \
+    ../../similaritykernels.h
+
+SOURCES += \
+    main.cpp \
+    ../../facegallery.cpp \
+    ../../galleryindex.cpp \
+    ../../hnswindex.cpp \
+    ../../similaritykernels.cpp
+
+include(../../opencv.pri)
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "facegallery.h"
+#include "hnswindex.h"
+
+// Usage: annbench [identities] [queries] [dimension]
+//
+// Identities are drawn around a few thousand cluster centres so the data has
+// the lumpy structure of real face embeddings; queries are enrolled rows
+// with added noise, like a second photo of the same person.
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Result
+{
+    double recall1;
+    double recall10;
+    double qps;
+};
+
+// Top 10 for every query; ms receives the total search time
+std::vector<GalleryMatch> searchAll(const FaceGallery &gallery, const std::vector<float> &queries, int dimension,
+                                    double *ms = nullptr)
+{
+    const int count = int(queries.size()) / dimension;
+    std::vector<GalleryMatch> found(size_t(count) * 10);
+
+    const Clock::time_point start = Clock::now();
+    for (int q = 0; q < count; ++q) {
+        gallery.search(&queries[size_t(q) * dimension], dimension, 10, &found[size_t(q) * 10]);
+    }
+    if (ms) *ms = elapsedMs(start);
+    return found;
+}
+
+// Recall@k: fraction of the exact top k found in the approximate top k
+Result score(const std::vector<GalleryMatch> &found, const std::vector<GalleryMatch> &truth, double ms)
+{
+    const int count = int(truth.size()) / 10;
+    int hits1 = 0;
+    int hits10 = 0;
+    for (int q = 0; q < count; ++q) {
+        const GalleryMatch *exact = &truth[size_t(q) * 10];
+        const GalleryMatch *approx = &found[size_t(q) * 10];
+        if (approx[0].identity == exact[0].identity) ++hits1;
+        for (int i = 0; i < 10; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                if (approx[j].identity == exact[i].identity) {
+                    ++hits10;
+                    break;
+                }
+            }
+        }
+    }
+
+    Result result;
+    result.recall1 = double(hits1) / count;
+    result.recall10 = double(hits10) / (count * 10.0);
+    result.qps = count / (ms / 1000.0);
+    return result;
+}
+
+Result measure(const FaceGallery &gallery, const std::vector<float> &queries, int dimension,
+               const std::vector<GalleryMatch> &truth)
+{
+    double ms = 0.0;
+    const std::vector<GalleryMatch> found = searchAll(gallery, queries, dimension, &ms);
+    return score(found, truth, ms);
+}
+
+void printRow(const char *index, const QString &setting, const Result &result)
+{
+    std::printf("%-12s %-14s %10.4f %10.4f %12.0f\n", index, qPrintable(setting),
+                result.recall1, result.recall10, result.qps);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const int identities = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int queryCount = argc > 2 ? std::atoi(argv[2]) : 1000;
+    const int dimension = argc > 3 ? std::atoi(argv[3]) : 512;
+    const int clusters = std::max(1, identities / 50);
+
+    std::mt19937 random(7);
+    std::normal_distribution<float> normal;
+
+    std::vector<float> centres(size_t(clusters) * dimension);
+    for (float &value : centres) value = normal(random);
+
+    FaceGallery gallery;
+    gallery.reset(dimension);
+    std::vector<float> feature(dimension);
+    std::uniform_int_distribution<int> pickCluster(0, clusters - 1);
+    std::vector<float> enrolled(size_t(identities) * dimension);
+    for (int i = 0; i < identities; ++i) {
+        const float *centre = &centres[size_t(pickCluster(random)) * dimension];
+        float *row = &enrolled[size_t(i) * dimension];
+        for (int d = 0; d < dimension; ++d) row[d] = centre[d] + 0.8f * normal(random);
+        gallery.add(QString(), row, dimension);
+    }
+
+    std::vector<float> queries(size_t(queryCount) * dimension);
+    std::uniform_int_distribution<int> pickIdentity(0, identities - 1);
+    for (int q = 0; q < queryCount; ++q) {
+        const float *row = &enrolled[size_t(pickIdentity(random)) * dimension];
+        for (int d = 0; d < dimension; ++d) queries[size_t(q) * dimension + d] = row[d] + 0.4f * normal(random);
+    }
+
+    std::printf("%d identities, %d queries, dimension %d, kernel %s\n\n",
+                identities, queryCount, dimension, FaceGallery::kernelName());
+    std::printf("%-12s %-14s %10s %10s %12s\n", "index", "setting", "recall@1", "recall@10", "QPS");
+
+    const std::vector<GalleryMatch> truth = searchAll(gallery, queries, dimension);
+    printRow("bruteforce", "exact", measure(gallery, queries, dimension, truth));
+
+    const int ms[] = { 16, 32 };
+    const int efSearches[] = { 16, 32, 64, 128, 256 };
+    for (int m : ms) {
+        HnswIndex::Params params;
+        params.m = m;
+        HnswIndex *hnsw = new HnswIndex(params);
+        const Clock::time_point start = Clock::now();
+        gallery.setIndex(std::unique_ptr<GalleryIndex>(hnsw));
+        std::printf("%-12s m=%-12d build %.1f s (%.0f inserts/s)\n", "hnsw", m,
+                    elapsedMs(start) / 1000.0, identities / (elapsedMs(start) / 1000.0));
+
+        for (int ef : efSearches) {
+            hnsw->setEfSearch(ef);
+            printRow("hnsw", QString("m=%1 ef=%2").arg(m).arg(ef), measure(gallery, queries, dimension, truth));
+        }
+    }
+
+    // Incremental delete: tombstone 5% of the identities in the live graph,
+    // then compare with an exact search over what is left and with a rebuild
+    HnswIndex *hnsw = new HnswIndex;
+    gallery.setIndex(std::unique_ptr<GalleryIndex>(hnsw));
+    std::uniform_int_distribution<int> pickRemoval(0, identities - 1);
+    for (int i = 0; i < identities / 20; ++i) gallery.remove(pickRemoval(random));
+
+    double tombstoneMs = 0.0;
+    const std::vector<GalleryMatch> tombstoned = searchAll(gallery, queries, dimension, &tombstoneMs);
+    gallery.setIndex(std::unique_ptr<GalleryIndex>(new BruteForceIndex));
+    const std::vector<GalleryMatch> remaining = searchAll(gallery, queries, dimension);
+    printRow("hnsw", "5% removed", score(tombstoned, remaining, tombstoneMs));
+
+    gallery.setIndex(std::unique_ptr<GalleryIndex>(new HnswIndex));
+    printRow("hnsw", "rebuilt", measure(gallery, queries, dimension, remaining));
+
+    return 0;
+}
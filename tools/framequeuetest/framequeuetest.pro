@@ -0,0 +1,20 @@
+# Checks FrameQueue's capacity and drop policies; exits non-zero on the first failure
+QT += core
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = framequeuetest
+
+INCLUDEPATH += $$PWD/../..
+
+HEADERS += \
+    ../../framemailbox.h \
+    ../../framepool.h \
+    ../../framequeue.h
+
+SOURCES += \
+    main.cpp \
+    ../../framepool.cpp
+
+include(../../opencv.pri)
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <vector>
+#include "framequeue.h"
+
+// Usage: framequeuetest
+//
+// Fills queues of capacity 1 and 2 past their capacity under every drop
+// policy and checks what is dropped, what comes out and in which order.
+// A queue that loses track of its cells hangs in take() instead of failing,
+// so run it under a timeout.
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *what, size_t capacity, const char *policy)
+{
+    if (condition) return;
+    std::printf("FAIL capacity %zu, %s: %s\n", capacity, policy, what);
+    ++failures;
+}
+
+FramePtr frame(uint64_t sequence, bool keyFrame = false)
+{
+    FramePtr frame(new CapturedFrame);
+    frame->sequence = sequence;
+    frame->keyFrame = keyFrame;
+    return frame;
+}
+
+std::vector<uint64_t> drain(FrameQueue &queue)
+{
+    std::vector<uint64_t> sequences;
+    while (FramePtr taken = queue.take()) sequences.push_back(taken->sequence);
+    return sequences;
+}
+
+// Publishes capacity + 1 ordinary frames numbered from 1
+void overfill(FrameQueue &queue, size_t capacity, const char *policy)
+{
+    for (uint64_t i = 1; i <= capacity; ++i) {
+        check(!queue.publish(frame(i)), "publish below capacity dropped a frame", capacity, policy);
+    }
+    check(queue.publish(frame(capacity + 1)), "publish at capacity dropped nothing", capacity, policy);
+    check(queue.droppedFrames() == 1, "dropped count is not 1", capacity, policy);
+}
+
+void testDropOldest(size_t capacity)
+{
+    FrameQueue queue(capacity, DropOldest);
+    check(queue.capacity() == capacity, "capacity() differs", capacity, "DropOldest");
+    overfill(queue, capacity, "DropOldest");
+    std::vector<uint64_t> expected;
+    for (uint64_t i = 2; i <= capacity + 1; ++i) expected.push_back(i);
+    check(drain(queue) == expected, "did not keep the newest frames in order", capacity, "DropOldest");
+
+    // Keeps working once emptied and wrapped around
+    check(!queue.publish(frame(10)), "publish into an emptied queue dropped a frame", capacity, "DropOldest");
+    check(drain(queue) == std::vector<uint64_t>{ 10 }, "lost a frame after wrapping", capacity, "DropOldest");
+}
+
+void testDropNewest(size_t capacity)
+{
+    FrameQueue queue(capacity, DropNewest);
+    overfill(queue, capacity, "DropNewest");
+    std::vector<uint64_t> expected;
+    for (uint64_t i = 1; i <= capacity; ++i) expected.push_back(i);
+    check(drain(queue) == expected, "did not keep the oldest frames in order", capacity, "DropNewest");
+
+    FramePtr spare = frame(10);
+    check(queue.tryPush(spare) && !spare, "tryPush into an emptied queue failed", capacity, "DropNewest");
+    for (uint64_t i = 11; i < 10 + capacity; ++i) queue.publish(frame(i));
+    FramePtr extra = frame(99);
+    check(!queue.tryPush(extra) && extra, "tryPush into a full queue succeeded", capacity, "DropNewest");
+}
+
+void testKeepKeyFrames(size_t capacity)
+{
+    FrameQueue queue(capacity, KeepKeyFrames);
+    overfill(queue, capacity, "KeepKeyFrames");
+    // A key frame evicts the oldest instead of being discarded
+    check(queue.publish(frame(50, true)), "key frame into a full queue dropped nothing", capacity, "KeepKeyFrames");
+    const std::vector<uint64_t> taken = drain(queue);
+    check(!taken.empty() && taken.back() == 50, "key frame was discarded", capacity, "KeepKeyFrames");
+    check(taken.size() == capacity, "queue holds more than its capacity", capacity, "KeepKeyFrames");
+}
+
+} // namespace
+
+int main()
+{
+    for (size_t capacity = 1; capacity <= 2; ++capacity) {
+        testDropOldest(capacity);
+        testDropNewest(capacity);
+        testKeepKeyFrames(capacity);
+    }
+    if (failures > 0) return 1;
+    std::printf("FrameQueue: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <QImage>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "previewscaler.h"
+
+// Average milliseconds per call after a short warm-up
+static double timeMs(int iterations, const std::function<void()> &body)
+{
+    for (int i = 0; i < 3; ++i) body();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+    const QSize display(960, 540);
+
+    struct Resolution { const char *name; int width; int height; };
+    const Resolution resolutions[] = {
+        { "720p", 1280, 720 },
+        { "1080p", 1920, 1080 },
+        { "4K", 3840, 2160 },
+    };
+
+    std::printf("Target %dx%d, %d iterations\n\n", display.width(), display.height(), iterations);
+    std::printf("%-6s %-24s %10s %8s\n", "input", "path", "ms/frame", "speedup");
+
+    for (const Resolution &resolution : resolutions) {
+        cv::Mat frame(resolution.height, resolution.width, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        const QSize target = QSize(frame.cols, frame.rows).scaled(display, Qt::KeepAspectRatio);
+
+        // The old preview: full-resolution RGB conversion, then a smooth Qt resample
+        cv::Mat rgb;
+        const double baseline = timeMs(iterations, [&]() {
+            cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
+            QImage image(rgb.data, rgb.cols, rgb.rows, int(rgb.step), QImage::Format_RGB888);
+            QImage scaled = image.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            (void)scaled;
+        });
+        std::printf("%-6s %-24s %10.3f %8s\n", resolution.name, "cvtColor+scaled", baseline, "1.00x");
+
+        QImage output(target, QImage::Format_RGB888);
+        const PreviewScaler::Kernel kernels[] = { PreviewScaler::Scalar, PreviewScaler::Sse41, PreviewScaler::Avx2 };
+        for (PreviewScaler::Kernel kernel : kernels) {
+            if (!PreviewScaler::isSupported(kernel)) continue;
+
+            PreviewScaler scaler(kernel);
+            const double ms = timeMs(iterations, [&]() {
+                scaler.scale(frame, output.bits(), target.width(), target.height(), int(output.bytesPerLine()));
+            });
+            char label[32];
+            std::snprintf(label, sizeof(label), "PreviewScaler (%s)", PreviewScaler::kernelName(kernel));
+            std::printf("%-6s %-24s %10.3f %7.2fx\n", resolution.name, label, ms, baseline / ms);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
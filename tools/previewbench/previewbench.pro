@@ -0,0 +1,17 @@
+# Micro-benchmark for the preview path: cvtColor + QImage::scaled vs PreviewScaler
+QT += core gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = previewbench
+
+INCLUDEPATH += $$PWD/../..
+
+HEADERS += \
+    ../../previewscaler.h
+
+SOURCES += \
+    main.cpp \
+    ../../previewscaler.cpp
+
+include(../../opencv.pri)
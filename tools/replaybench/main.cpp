@@ -0,0 +1,335 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <sys/resource.h>
+#include "engineconfig.h"
+#include "modelmanager.h"
+#include "streamconfig.h"
+#include "streamengine.h"
+
+// Usage: replaybench --model <pack> [--streams N] [--fps F] [--loops L] video...
+//
+// Every stream replays one of the given files (round robin). With the
+// default --fps -1 frames are handed over losslessly as fast as the engine
+// takes them, so FPS is the pipeline's throughput; a positive --fps
+// simulates live cameras and latency then includes any queueing. Latency is
+// measured from the moment a frame is decoded until its results are ready.
+// Heap allocations and fresh FramePool buffers are counted once the first
+// kSteadyAfterFrames frames are through. The steady-state frame loop must not
+// allocate, so the exit status is 2 when either count is above zero.
+// Allocations inside SDK calls are the SDK's own and are left out, as are
+// the benchmark's own bookkeeping. No EventRecorder is attached, so the gate
+// does not cover recording: events encode JPEGs and buffer clips on the heap.
+
+namespace {
+
+const uint64_t kSteadyAfterFrames = 300;
+
+// Every operator new outside SDK calls; OpenCV's cv::Mat buffers bypass it and are reported by FramePool
+std::atomic<uint64_t> heapAllocations(0);
+
+// Set while the benchmark records its own figures
+thread_local int uncounted = 0;
+
+struct Uncounted
+{
+    Uncounted() { ++uncounted; }
+    ~Uncounted() { --uncounted; }
+};
+
+struct StreamStats
+{
+    std::vector<double> latencyMs;
+    uint64_t detected = 0;
+    uint64_t predicted = 0;
+};
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    const size_t rank = size_t(std::max(0.0, std::min(1.0, p)) * (sorted.size() - 1) + 0.5);
+    return sorted[rank];
+}
+
+double seconds(const timeval &tv)
+{
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    if (!uncounted && !InspireFaceCall::active()) heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay video files through the face pipeline and report throughput");
+    parser.addHelpOption();
+    QCommandLineOption modelOption(QStringList() << "m" << "model", "InspireFace model pack", "file");
+    QCommandLineOption configOption(QStringList() << "c" << "config", "streams.json for recognition settings", "file");
+    QCommandLineOption streamsOption(QStringList() << "s" << "streams", "Concurrent streams", "count", "1");
+    QCommandLineOption fpsOption("fps", "Frames per second per stream, -1 = as fast as possible, 0 = file rate", "fps", "-1");
+    QCommandLineOption loopsOption("loops", "Times each file is played", "count", "1");
+    QCommandLineOption detectWidthOption("detect-width", "Width handed to detection, 0 = native", "pixels", "0");
+    QCommandLineOption intervalOption("max-detect-interval", "Upper bound on frames between detections", "frames", "5");
+    QCommandLineOption queueOption("queue-size", "Frames buffered per stream between capture and detection", "frames", "1");
+    QCommandLineOption maxAgeOption("max-frame-age", "Skip frames older than this before detection, 0 = never", "ms", "0");
+    QCommandLineOption motionOption("motion-threshold", "Share of the motion thumbnail that must change, 0 = no motion gate", "fraction", "0.002");
+    QCommandLineOption maxFacesOption("max-faces", "Faces each session tracks at once, overrides the config", "count");
+    QCommandLineOption coldOption("cold", "Skip the session warm-up, to measure what it saves");
+    QCommandLineOption jsonOption("json", "Print the report as one JSON object");
+    parser.addOption(modelOption);
+    parser.addOption(configOption);
+    parser.addOption(streamsOption);
+    parser.addOption(fpsOption);
+    parser.addOption(loopsOption);
+    parser.addOption(detectWidthOption);
+    parser.addOption(intervalOption);
+    parser.addOption(queueOption);
+    parser.addOption(maxAgeOption);
+    parser.addOption(motionOption);
+    parser.addOption(maxFacesOption);
+    parser.addOption(coldOption);
+    parser.addOption(jsonOption);
+    parser.addPositionalArgument("video", "Recorded video files");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty() || !parser.isSet(modelOption)) {
+        parser.showHelp(1);
+    }
+
+    EngineConfig engineConfig;
+    if (parser.isSet(configOption)) {
+        QFile file(parser.value(configOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical() << "Cannot open" << file.fileName();
+            return 1;
+        }
+        engineConfig = EngineConfig::fromJson(QJsonDocument::fromJson(file.readAll()).object());
+    }
+    if (parser.isSet(maxFacesOption)) {
+        engineConfig.maxDetectFaces = std::max(1, parser.value(maxFacesOption).toInt());
+    }
+
+    const int streamCount = std::max(1, parser.value(streamsOption).toInt());
+    QVector<StreamConfig> configs;
+    for (int i = 0; i < streamCount; ++i) {
+        StreamConfig config;
+        config.name = QString("replay-%1").arg(i);
+        config.url = files[i % files.size()];
+        config.replayFps = parser.value(fpsOption).toDouble();
+        config.replayLoops = std::max(1, parser.value(loopsOption).toInt());
+        config.detectWidth = parser.value(detectWidthOption).toInt();
+        config.maxDetectInterval = std::max(1, parser.value(intervalOption).toInt());
+        config.queueSize = std::max(1, parser.value(queueOption).toInt());
+        config.maxFrameAgeMs = parser.value(maxAgeOption).toDouble();
+        config.motionThreshold = parser.value(motionOption).toDouble();
+        configs.append(config);
+    }
+
+    ModelManager models;
+    QString error;
+    QString warning;
+    const int poolSize = std::max(QThread::idealThreadCount(), streamCount);
+    if (!parser.isSet(coldOption)) models.setWarmUpSizes(ModelManager::warmUpSizes(configs));
+    if (!models.load(parser.value(modelOption), engineConfig, poolSize, &error, &warning)) {
+        qCritical() << error;
+        return 1;
+    }
+    if (!warning.isEmpty()) qWarning() << warning;
+
+    // Each stream only ever writes its own slot, and calls for one stream never overlap
+    std::vector<StreamStats> stats(streamCount);
+    for (StreamStats &stream : stats) {
+        // Growing these would show up as frame-loop allocations
+        stream.latencyMs.reserve(1 << 16);
+    }
+    std::atomic<uint64_t> framesDone(0);
+    std::atomic<uint64_t> steadyAllocations(0);
+    std::atomic<uint64_t> steadyBufferAllocations(0);
+    StreamEngine engine;
+    models.configure(engine);
+    engine.setPreviewPaused(true);
+    engine.setResultCallback([&](int index, const CapturedFrame &frame, const std::vector<FaceDetection> &,
+                                 bool detected) {
+        Uncounted bookkeeping;
+        StreamStats &stream = stats[index];
+        stream.latencyMs.push_back((steadyNowNs() - frame.captureTimeNs) / 1e6);
+        ++(detected ? stream.detected : stream.predicted);
+        if (framesDone.fetch_add(1, std::memory_order_relaxed) + 1 == kSteadyAfterFrames) {
+            steadyAllocations.store(heapAllocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            steadyBufferAllocations.store(engine.frameBufferAllocations(), std::memory_order_relaxed);
+        }
+    });
+
+    int exitCode = 0;
+    QObject::connect(&engine, &StreamEngine::streamEnded, [&]() {
+        if (engine.liveStreamCount() == 0) app.quit();
+    });
+    QObject::connect(&engine, &StreamEngine::streamOpenFailed, [&](int, const QString &url) {
+        qCritical() << "Cannot open" << url;
+        exitCode = 1;
+        app.quit();
+    });
+
+    rusage usageStart;
+    getrusage(RUSAGE_SELF, &usageStart);
+    const auto wallStart = std::chrono::steady_clock::now();
+    if (!engine.start(configs, models.models(), &error)) {
+        qCritical() << error;
+        return 1;
+    }
+    app.exec();
+    const uint64_t allocationsEnd = heapAllocations.load(std::memory_order_relaxed);
+    const uint64_t framesEnd = framesDone.load(std::memory_order_relaxed);
+    const uint64_t dropped = engine.droppedFrames();
+    const uint64_t bufferAllocations = engine.frameBufferAllocations();
+    const uint64_t bufferReuses = engine.frameBufferReuses();
+    const uint64_t late = engine.lateFrames();
+    const int workers = engine.workerCount();
+    // Startup figures of the slowest stream to settle
+    PipelineMetricsSnapshot startup;
+    for (const PipelineMetricsSnapshot &stream : engine.metricsSnapshot()) {
+        if (stream.startupMs > startup.startupMs) startup = stream;
+    }
+    engine.stop();
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    rusage usageEnd;
+    getrusage(RUSAGE_SELF, &usageEnd);
+    const double loadMs = models.loadMs();
+    const double warmUpMs = models.warmUpMs();
+    models.unload();
+    if (exitCode != 0) return exitCode;
+
+    std::vector<double> latency;
+    uint64_t detected = 0;
+    uint64_t predicted = 0;
+    for (const StreamStats &stream : stats) {
+        latency.insert(latency.end(), stream.latencyMs.begin(), stream.latencyMs.end());
+        detected += stream.detected;
+        predicted += stream.predicted;
+    }
+    std::sort(latency.begin(), latency.end());
+
+    const double userSeconds = seconds(usageEnd.ru_utime) - seconds(usageStart.ru_utime);
+    const double systemSeconds = seconds(usageEnd.ru_stime) - seconds(usageStart.ru_stime);
+    const double cpuPercent = 100.0 * (userSeconds + systemSeconds) / wallSeconds;
+#ifdef __APPLE__
+    const double peakRssMb = usageEnd.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+    const double peakRssMb = usageEnd.ru_maxrss / 1024.0;            // kilobytes
+#endif
+    const double fps = latency.size() / wallSeconds;
+    // Both stay 0 when the run was too short to reach steady state
+    const bool steady = framesEnd > kSteadyAfterFrames;
+    const uint64_t steadyHeap = steady ? allocationsEnd - steadyAllocations.load() : 0;
+    const uint64_t steadyBuffers = steady ? bufferAllocations - steadyBufferAllocations.load() : 0;
+    const double steadyAllocationsPerFrame = steady ? double(steadyHeap) / (framesEnd - kSteadyAfterFrames) : -1.0;
+    const int gateStatus = steadyHeap > 0 || steadyBuffers > 0 ? 2 : 0;
+    if (!steady) {
+        qWarning() << "Kurang dari" << kSteadyAfterFrames << "frame, alokasi steady state tidak diperiksa";
+    } else if (gateStatus != 0) {
+        qCritical() << "Frame loop masih mengalokasikan:" << steadyHeap << "alokasi heap dan" << steadyBuffers
+                    << "buffer frame baru setelah" << kSteadyAfterFrames << "frame pertama";
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject report;
+        report["streams"] = streamCount;
+        report["frames"] = double(latency.size());
+        report["detectedFrames"] = double(detected);
+        report["predictedFrames"] = double(predicted);
+        report["droppedFrames"] = double(dropped);
+        report["lateFrames"] = double(late);
+        report["wallSeconds"] = wallSeconds;
+        report["fps"] = fps;
+        report["fpsPerStream"] = fps / streamCount;
+        report["latencyP50Ms"] = percentile(latency, 0.50);
+        report["latencyP90Ms"] = percentile(latency, 0.90);
+        report["latencyP99Ms"] = percentile(latency, 0.99);
+        report["latencyMaxMs"] = latency.empty() ? 0.0 : latency.back();
+        report["cpuUserSeconds"] = userSeconds;
+        report["cpuSystemSeconds"] = systemSeconds;
+        report["cpuPercent"] = cpuPercent;
+        report["cores"] = QThread::idealThreadCount();
+        report["peakRssMb"] = peakRssMb;
+        report["maxDetectFaces"] = engineConfig.maxDetectFaces;
+        report["featureExtractions"] = double(engine.featureExtractions());
+        report["reusedEmbeddings"] = double(engine.reusedEmbeddings());
+        report["motionSkippedFrames"] = double(engine.motionSkippedFrames());
+        report["frameBufferAllocations"] = double(bufferAllocations);
+        report["frameBufferReuses"] = double(bufferReuses);
+        report["steadyAllocations"] = double(steadyHeap);
+        report["steadyFrameBufferAllocations"] = double(steadyBuffers);
+        report["steadyAllocationsPerFrame"] = steadyAllocationsPerFrame;
+        report["modelLoadMs"] = loadMs;
+        report["warmUpMs"] = warmUpMs;
+        report["startupMs"] = startup.startupMs;
+        report["firstDetectMs"] = startup.firstDetectMs;
+        report["steadyDetectMs"] = startup.steadyDetectMs;
+        std::printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Compact).constData());
+        return gateStatus;
+    }
+
+    std::printf("streams          %d (%d worker threads, %d cores)\n", streamCount, workers,
+                QThread::idealThreadCount());
+    std::printf("frames           %zu (%llu detected, %llu extrapolated, %llu dropped, %llu late)\n",
+                latency.size(), (unsigned long long)detected, (unsigned long long)predicted,
+                (unsigned long long)dropped, (unsigned long long)late);
+    std::printf("wall time        %.2f s\n", wallSeconds);
+    std::printf("throughput       %.1f FPS total, %.1f FPS per stream\n", fps, fps / streamCount);
+    std::printf("latency          p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                percentile(latency, 0.50), percentile(latency, 0.90), percentile(latency, 0.99),
+                latency.empty() ? 0.0 : latency.back());
+    std::printf("cpu              %.2f s user, %.2f s system, %.0f%% of one core (%.0f%% of all)\n",
+                userSeconds, systemSeconds, cpuPercent, cpuPercent / QThread::idealThreadCount());
+    std::printf("peak rss         %.1f MB\n", peakRssMb);
+    // Without the track cache every tracked face would be extracted on every detection
+    const uint64_t extractions = engine.featureExtractions();
+    const uint64_t reused = engine.reusedEmbeddings();
+    std::printf("extractions      %llu, %llu served from the track cache (%.1fx fewer, up to %d faces per session)\n",
+                (unsigned long long)extractions, (unsigned long long)reused,
+                extractions > 0 ? double(extractions + reused) / extractions : 0.0, engineConfig.maxDetectFaces);
+    std::printf("motion skipped   %llu detections\n", (unsigned long long)engine.motionSkippedFrames());
+    std::printf("frame buffers    %llu allocated, %llu reused\n", (unsigned long long)bufferAllocations,
+                (unsigned long long)bufferReuses);
+    if (steady) {
+        std::printf("steady state     %llu heap allocations (%.2f per frame), %llu new frame buffers "
+                    "after the first %llu frames\n", (unsigned long long)steadyHeap, steadyAllocationsPerFrame,
+                    (unsigned long long)steadyBuffers, (unsigned long long)kSteadyAfterFrames);
+    }
+    std::printf("model load       %.0f ms (%.0f ms warm-up)\n", loadMs, warmUpMs);
+    std::printf("startup          %.0f ms to steady detection (first %.2f ms, steady %.2f ms)\n",
+                startup.startupMs, startup.firstDetectMs, startup.steadyDetectMs);
+    return gateStatus;
+}
@@ -0,0 +1,15 @@
+# Offline throughput benchmark: replays video files through the full
+# capture -> HFExecuteFaceTrack -> post-processing path without cameras or network
+QT += core
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = replaybench
+
+include(../../core.pri)
+
+SOURCES += \
+    main.cpp
+
+unix: QMAKE_RPATHDIR += $$PWD/../../InspireFace/lib
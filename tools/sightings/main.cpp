@@ -0,0 +1,166 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "latencyhistogram.h"
+#include "sightingslog.h"
+
+// Usage: sightings --dir <path> [--stream name] [--from time] [--to time] [--json]
+//        sightings --dir <path> --bench N [--streams S]
+//
+// Times are ISO 8601 (local time unless suffixed) or milliseconds since the
+// epoch. --bench feeds N synthetic tracks through onFrame() the way the
+// engine does, then reports the per-frame cost, the write rate and how long
+// a one-hour query takes.
+
+namespace {
+
+int64_t parseTime(const QString &text, int64_t fallback)
+{
+    if (text.isEmpty()) return fallback;
+    bool ok = false;
+    const qint64 ms = text.toLongLong(&ok);
+    if (ok) return ms;
+    const QDateTime time = QDateTime::fromString(text, Qt::ISODate);
+    return time.isValid() ? time.toMSecsSinceEpoch() : fallback;
+}
+
+int bench(const QString &directory, int tracks, int streamCount)
+{
+    QStringList names;
+    for (int i = 0; i < streamCount; ++i) names << QString("bench-%1").arg(i);
+
+    SightingsLog log;
+    log.setDirectory(directory);
+    log.start(names);
+
+    // Every track lives for 25 frames; a new one starts on each stream every frame
+    const int64_t frameNs = 40 * 1000000;
+    int64_t timeNs = LatencyHistogram::nowNs();
+    std::vector<std::vector<FaceDetection>> faces(streamCount);
+    LatencyHistogram cost;
+    int started = 0;
+    int nextTrack = 1;
+    while (started < tracks) {
+        for (int stream = 0; stream < streamCount; ++stream) {
+            std::vector<FaceDetection> &current = faces[stream];
+            if (!current.empty() && current.front().trackId <= nextTrack - 25 * streamCount) {
+                current.erase(current.begin());
+            }
+            if (started < tracks) {
+                FaceDetection face;
+                face.trackId = nextTrack++;
+                face.confidence = 0.9f;
+                face.quality = 0.5f;
+                current.push_back(face);
+                ++started;
+            }
+            const int64_t before = LatencyHistogram::nowNs();
+            log.onFrame(stream, timeNs, current, 0);
+            cost.record(LatencyHistogram::nowNs() - before);
+        }
+        timeNs += frameNs;
+    }
+
+    const auto stopStarted = std::chrono::steady_clock::now();
+    log.stop();
+    const double stopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stopStarted).count();
+
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    std::vector<SightingRecord> results;
+    const auto queryStarted = std::chrono::steady_clock::now();
+    SightingsLog::query(directory, names.first(), now - 3600 * 1000, now + 3600 * 1000, &results);
+    const double queryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryStarted).count();
+
+    const LatencyHistogram::Snapshot snapshot = cost.snapshot();
+    std::printf("sightings        %llu written\n", (unsigned long long)log.sightingsWritten());
+    std::printf("onFrame          mean %.4f ms, p99 %.4f ms, max %.4f ms\n",
+                snapshot.meanMs(), snapshot.percentileMs(0.99), snapshot.maxMs());
+    std::printf("final flush      %.1f ms\n", stopSeconds * 1000.0);
+    std::printf("query            %zu sightings of one stream in %.2f ms\n", results.size(), queryMs);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Query or benchmark the sightings log");
+    parser.addHelpOption();
+    QCommandLineOption dirOption(QStringList() << "d" << "dir", "Sightings directory", "path");
+    QCommandLineOption streamOption(QStringList() << "s" << "stream", "Stream name, all streams when omitted", "name");
+    QCommandLineOption fromOption("from", "Range start, default one hour ago", "time");
+    QCommandLineOption toOption("to", "Range end, default now", "time");
+    QCommandLineOption jsonOption("json", "Print one JSON object per sighting");
+    QCommandLineOption benchOption("bench", "Write this many synthetic tracks and time it", "count");
+    QCommandLineOption streamsOption("streams", "Streams for --bench", "count", "8");
+    parser.addOption(dirOption);
+    parser.addOption(streamOption);
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+    parser.addOption(jsonOption);
+    parser.addOption(benchOption);
+    parser.addOption(streamsOption);
+    parser.process(app);
+
+    const QString directory = parser.value(dirOption);
+    if (directory.isEmpty()) parser.showHelp(1);
+    if (parser.isSet(benchOption)) {
+        return bench(directory, std::max(1, parser.value(benchOption).toInt()),
+                     std::max(1, parser.value(streamsOption).toInt()));
+    }
+
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    const int64_t to = parseTime(parser.value(toOption), now);
+    const int64_t from = parseTime(parser.value(fromOption), to - 3600 * 1000);
+
+    std::vector<SightingRecord> results;
+    QString error;
+    if (!SightingsLog::query(directory, parser.value(streamOption), from, to, &results, &error)) {
+        qCritical() << error;
+        return 1;
+    }
+
+    // Ids missing from identities.tsv are shown as numbers rather than dropped
+    const QHash<uint32_t, QString> names = SightingsLog::identityNames(directory);
+    for (const SightingRecord &record : results) {
+        const QString identity = record.identityId == 0 ? QString()
+                                 : names.value(record.identityId, QString("#%1").arg(record.identityId));
+        if (parser.isSet(jsonOption)) {
+            QJsonObject line;
+            line["firstMs"] = double(record.firstMs);
+            line["lastMs"] = double(record.lastMs);
+            line["streamId"] = double(record.streamId);
+            line["trackId"] = record.trackId;
+            if (!identity.isEmpty()) line["identity"] = identity;
+            line["frames"] = double(record.frames);
+            line["confidence"] = record.confidence;
+            line["quality"] = record.quality;
+            line["yaw"] = record.yaw;
+            line["pitch"] = record.pitch;
+            line["roll"] = record.roll;
+            if (record.eventMs) line["eventMs"] = double(record.eventMs);
+            std::printf("%s\n", QJsonDocument(line).toJson(QJsonDocument::Compact).constData());
+        } else {
+            std::printf("%s  %6.1f s  track %-6d %-20s conf %.2f quality %.2f\n",
+                        qPrintable(QDateTime::fromMSecsSinceEpoch(record.firstMs).toString(Qt::ISODate)),
+                        (record.lastMs - record.firstMs) / 1000.0, record.trackId,
+                        qPrintable(identity.isEmpty() ? QString("-") : identity),
+                        record.confidence, record.quality);
+        }
+    }
+    if (!parser.isSet(jsonOption)) {
+        std::printf("%zu sightings\n", results.size());
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+# Queries the sightings log by stream and time range, or measures how fast it can be written
+QT += core
+QT -= gui
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = sightings
+
+INCLUDEPATH += $$PWD/../..
+
+HEADERS += \
+    ../../latencyhistogram.h \
+    ../../sightingslog.h
+
+SOURCES += \
+    main.cpp \
+    ../../latencyhistogram.cpp \
+    ../../sightingslog.cpp
+
+include(../../opencv.pri)
@@ -0,0 +1,85 @@
+#include "trackembeddingcache.h"
+#include <algorithm>
+
+TrackEmbeddingCache::TrackEmbeddingCache(double refreshMs, float gain)
+    : refreshNs(int64_t(refreshMs * 1e6))
+    , qualityGain(gain)
+    , live(0)
+{
+}
+
+const TrackEmbeddingCache::Entry *TrackEmbeddingCache::find(int trackId) const
+{
+    for (size_t i = 0; i < live; ++i) {
+        if (entries[i].trackId == trackId) return &entries[i];
+    }
+    return nullptr;
+}
+
+TrackEmbeddingCache::Entry &TrackEmbeddingCache::findOrAdd(int trackId)
+{
+    for (size_t i = 0; i < live; ++i) {
+        if (entries[i].trackId == trackId) return entries[i];
+    }
+    if (live == entries.size()) entries.push_back(Entry());
+    Entry &entry = entries[live++];
+    entry.feature.clear();
+    entry.analysis = FaceAnalysis();
+    entry.trackId = trackId;
+    entry.quality = -1.0f;
+    entry.extractedNs = 0;
+    entry.identity = -1;
+    entry.matchScore = 0.0f;
+    return entry;
+}
+
+bool TrackEmbeddingCache::needsExtraction(int trackId, float quality, int64_t nowNs) const
+{
+    const Entry *entry = find(trackId);
+    if (!entry || entry->feature.empty()) return true;
+    if (refreshNs > 0 && nowNs - entry->extractedNs >= refreshNs) return true;
+    return quality >= entry->quality + qualityGain;
+}
+
+void TrackEmbeddingCache::store(int trackId, float quality, const float *feature, int length,
+                                int identity, float matchScore, int64_t nowNs)
+{
+    Entry &entry = findOrAdd(trackId);
+    entry.quality = quality;
+    entry.extractedNs = nowNs;
+    entry.identity = identity;
+    entry.matchScore = matchScore;
+    entry.feature.assign(feature, feature + length);
+}
+
+bool TrackEmbeddingCache::apply(FaceDetection &face) const
+{
+    const Entry *entry = find(face.trackId);
+    if (!entry || entry->feature.empty()) return false;
+    face.identity = entry->identity;
+    face.matchScore = entry->matchScore;
+    return true;
+}
+
+void TrackEmbeddingCache::applyAnalysis(FaceDetection &face) const
+{
+    const Entry *entry = find(face.trackId);
+    face.analysis = entry ? entry->analysis : FaceAnalysis();
+}
+
+void TrackEmbeddingCache::storeAnalysis(int trackId, const FaceAnalysis &analysis)
+{
+    findOrAdd(trackId).analysis = analysis;
+}
+
+void TrackEmbeddingCache::retain(const std::vector<FaceDetection> &faces)
+{
+    // Ended tracks move behind live by swapping, so their feature storage stays for the next track
+    const auto ended = std::partition(entries.begin(), entries.begin() + live, [&faces](const Entry &entry) {
+        for (const FaceDetection &face : faces) {
+            if (face.trackId == entry.trackId) return true;
+        }
+        return false;
+    });
+    live = size_t(ended - entries.begin());
+}
@@ -0,0 +1,63 @@
+#ifndef TRACKEMBEDDINGCACHE_H
+#define TRACKEMBEDDINGCACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "facedetection.h"
+
+// Remembers the best embedding seen so far for every live track of one
+// stream, so a face is extracted and searched once per person instead of once
+// per frame. A track is extracted again only when its face quality beats the
+// cached one by qualityGain, or when the cached embedding is older than
+// refreshMs (the fresh one then replaces it whatever its quality). The
+// results of the optional FaceStage analyses are kept per track the same
+// way, so each stage runs once per person. Entries are dropped as soon as
+// their track disappears.
+class TrackEmbeddingCache
+{
+public:
+    TrackEmbeddingCache(double refreshMs = 2000.0, float qualityGain = 0.1f);
+
+    void clear() { live = 0; }
+    int size() const { return int(live); }
+
+    bool needsExtraction(int trackId, float quality, int64_t nowNs) const;
+
+    // Records a fresh embedding and its gallery match for the track
+    void store(int trackId, float quality, const float *feature, int length,
+               int identity, float matchScore, int64_t nowNs);
+
+    // Copies the cached match into face; returns false for tracks without an embedding
+    bool apply(FaceDetection &face) const;
+
+    // Copies the stage results cached for the face's track into face.analysis
+    void applyAnalysis(FaceDetection &face) const;
+    void storeAnalysis(int trackId, const FaceAnalysis &analysis);
+
+    // Drops every track that is not among faces
+    void retain(const std::vector<FaceDetection> &faces);
+
+private:
+    struct Entry
+    {
+        int trackId;
+        float quality;
+        int64_t extractedNs;
+        int identity;
+        float matchScore;
+        std::vector<float> feature; // Empty until the track is first extracted
+        FaceAnalysis analysis;
+    };
+
+    const Entry *find(int trackId) const;
+    Entry &findOrAdd(int trackId);
+
+    int64_t refreshNs;
+    float qualityGain;
+    // A handful of live tracks, so a linear scan is enough. Entries past live
+    // belong to ended tracks and are reused with their feature storage.
+    std::vector<Entry> entries;
+    size_t live;
+};
+
+#endif // TRACKEMBEDDINGCACHE_H
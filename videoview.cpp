@@ -0,0 +1,39 @@
+#include "videoview.h"
+#include <QPaintEvent>
+#include <QPainter>
+
+VideoView::VideoView(QWidget *parent)
+    : QWidget(parent)
+    , hasFrame(false)
+{
+}
+
+QImage *VideoView::frameImage(const QSize &frameSize)
+{
+    const QSize target = frameSize.scaled(size(), Qt::KeepAspectRatio);
+    if (target.isEmpty()) return nullptr;
+    if (image.size() != target) {
+        image = QImage(target, QImage::Format_RGB888);
+    }
+    return &image;
+}
+
+void VideoView::present()
+{
+    hasFrame = true;
+    update();
+}
+
+void VideoView::clear()
+{
+    // The image stays allocated for the next stream
+    hasFrame = false;
+    update();
+}
+
+void VideoView::paintEvent(QPaintEvent *)
+{
+    if (!hasFrame) return;
+    QPainter painter(this);
+    painter.drawImage(QPoint((width() - image.width()) / 2, (height() - image.height()) / 2), image);
+}
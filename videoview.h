@@ -0,0 +1,32 @@
+#ifndef VIDEOVIEW_H
+#define VIDEOVIEW_H
+
+#include <QImage>
+#include <QWidget>
+
+// Single stream preview. Frames are drawn straight into an image the size
+// they are shown at, which paintEvent() blits as is; the image is
+// reallocated only when the widget or the frame shape changes, so a running
+// preview costs no allocation per frame.
+class VideoView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit VideoView(QWidget *parent = nullptr);
+
+    // Image for a frame of frameSize, as large as fits the widget with the same
+    // aspect ratio; nullptr when there is no room. Call present() once drawn.
+    QImage *frameImage(const QSize &frameSize);
+    void present();
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QImage image;
+    bool hasFrame;
+};
+
+#endif // VIDEOVIEW_H